@@ -0,0 +1,21 @@
+#ifndef BOARD_H_
+#define BOARD_H_
+
+#include "hal.h"
+
+/* pins used on the nucleo-f446re board */
+/* each entry is PIN(arg, port, pinno, mode, af, speed, pull, otype), the
+table is turned into one GPIO_Port_Config per port at compile time with
+GPIO_PORT_CONFIG(BOARD_PIN_TABLE, port) */
+/* the af of pins that are not in alternate function mode is ignored by
+the hardware, AF0 is used for them */
+#define BOARD_PIN_TABLE(PIN, arg)                                                                                \
+    /* LD2 (green led), driven by tim2 channel 1 */                                                         \
+    PIN(arg, GPIO_PORT_A, 5,  GPIO_MODE_AF,     AF1, GPIO_SPEED_LOW,    GPIO_PULL_NONE, GPIO_OUTPUT_PUSH_PULL)  \
+    /* B1 (blue user button), pulled up externally on the board */                                          \
+    PIN(arg, GPIO_PORT_C, 13, GPIO_MODE_INPUT,  AF0, GPIO_SPEED_LOW,    GPIO_PULL_NONE, GPIO_OUTPUT_PUSH_PULL)  \
+    /* usart2 tx and rx, connected to the st-link virtual com port */                                       \
+    PIN(arg, GPIO_PORT_A, 2,  GPIO_MODE_AF,     AF7, GPIO_SPEED_MEDIUM, GPIO_PULL_NONE, GPIO_OUTPUT_PUSH_PULL)  \
+    PIN(arg, GPIO_PORT_A, 3,  GPIO_MODE_AF,     AF7, GPIO_SPEED_MEDIUM, GPIO_PULL_UP,   GPIO_OUTPUT_PUSH_PULL)
+
+#endif // BOARD_H_
\ No newline at end of file
@@ -4,11 +4,17 @@
 #define BIT(x) (1UL << (x)) // convenience macro
 
 /* driver includes */
+#include "drivers/include/dma.h"
+#include "drivers/include/dwt.h"
 #include "drivers/include/exti.h"
+#include "drivers/include/flash.h"
 #include "drivers/include/gpio.h"
 #include "drivers/include/nvic.h"
+#include "drivers/include/pwr.h"
 #include "drivers/include/rcc.h"
+#include "drivers/include/scb.h"
 #include "drivers/include/systick.h"
+#include "drivers/include/tim.h"
 #include "drivers/include/usart.h"
 
 #endif // HAL_H_
\ No newline at end of file
@@ -1,10 +1,75 @@
 #ifndef MAIN_H_
 #define MAIN_H_
 
+#include "board.h"
 #include "hal.h"
 #include "interrupts.h"
+#include "startup.h"
 
-#define SYS_FREQ 16000000 // system operating frequency in hz
+/* service includes */
+#include "services/include/debounce.h"
+#include "services/include/format.h"
+#include "services/include/kernel.h"
+#include "services/include/latency.h"
+#include "services/include/log.h"
+#include "services/include/pool.h"
+#include "services/include/profile.h"
+#include "services/include/sched.h"
+#include "services/include/timer.h"
+
+/* interrupt priorities, 0 is the highest and 15 the lowest */
+/* systick is highest so timekeeping is never delayed by other handlers,
+usart2 comes next so received bytes are read before the next one overruns */
+#define IRQ_PRIORITY_SYSTICK 0U
+#define IRQ_PRIORITY_USART   1U
+#define IRQ_PRIORITY_DMA     2U
+#define IRQ_PRIORITY_EXTI    3U
+
+/* tickless idle, 1 to stop the systick interrupt while the main loop sleeps
+until the next software timer expires, 0 to sleep with a systick interrupt
+every tick. can be overridden with make EXTRA_CFLAGS=-DTICKLESS_IDLE=0 */
+#ifndef TICKLESS_IDLE
+#define TICKLESS_IDLE 1
+#endif
+
+/* scheduler priorities of the event handlers, higher runs first */
+#define TASK_PRIORITY_LOG    0U
+#define TASK_PRIORITY_TIMER  0U
+#define TASK_PRIORITY_USART  1U
+#define TASK_PRIORITY_BUTTON 2U
+
+/* kernel threads, used when KERNEL is 1 */
+/* the event scheduler runs in the lowest application thread, the stack
+monitor above it so it still runs while the event handlers are busy */
+#define THREAD_PRIORITY_EVENTS  1U
+#define THREAD_PRIORITY_MONITOR 2U
+#define THREAD_STACK_EVENTS     512U
+#define THREAD_STACK_MONITOR    128U
+
+/* the stack monitor checks the threads every second and warns when one
+of them has less than 32 words of stack that were never used */
+#define STACK_MONITOR_INTERVAL 1000U
+#define STACK_MONITOR_LOW      32U
+
+/* longest frame handled from usart2 in bytes, longer frames are cut off,
+and number of frames that can wait for Frame_Handler */
+#define FRAME_MAX_LEN     32U
+#define FRAME_POOL_BLOCKS 8U
+
+/* id of the user button in debounce events */
+#define BUTTON_USER 0U
+
+/* led pwm frequency in hz and number of steps in one breath, one step is
+taken every pwm period so a breath takes 256 / 200 Hz = 1.28 s */
+#define LED_PWM_FREQ      200U
+#define LED_BREATHE_STEPS 256U
+
+/* interval between exti latency probes in ticks */
+/* the probes are triggered from software on exti line 10, which is not
+connected to a pin (no edge trigger), and share the interrupt with the
+button on line 13 */
+#define LATENCY_PROBE_INTERVAL 100U
+#define LATENCY_PROBE_LINE     EXTI_LINE_10
 
 int main(void);
 
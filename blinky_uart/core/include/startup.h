@@ -0,0 +1,18 @@
+#ifndef STARTUP_H_
+#define STARTUP_H_
+
+#include "main.h"
+
+/* use ldm/stm to copy .data/.ramfunc and a 16-byte unrolled loop to clear .bss,
+build with EXTRA_CFLAGS=-DSTARTUP_FAST_INIT=0 for the plain word-at-a-time loops */
+#ifndef STARTUP_FAST_INIT
+#define STARTUP_FAST_INIT 1
+#endif
+
+/* core clock cycles spent between reset and the call to main() */
+extern uint32_t startup_cycles;
+
+/* copy the vector table to sram so handlers can be replaced at runtime */
+void Vector_Table_Relocate(void);
+
+#endif // STARTUP_H_
\ No newline at end of file
@@ -1,33 +1,84 @@
 #include "core/include/interrupts.h"
 
 /* increment system tick counter each time a systick
-interrupt is generated */
-void SysTick_Handler(void)
+interrupt is generated, advance the software timers and the kernel's
+time slice */
+/* the tick is counted first, so SYSTICK_Now is up to date for everything
+the handler calls */
+RAMFUNC void SysTick_Handler(void)
 {
     SYSTICK_Inc_Ticks();
+#if LATENCY_TRACE
+    LATENCY_SysTick_Entry();
+#endif
+    PROFILE_BEGIN(SYSTICK_IRQ);
+    TIMER_Tick();
+#if KERNEL
+    KERNEL_Tick();
+#endif
+    PROFILE_END(SYSTICK_IRQ);
 }
 
-/* exti interrupt handler */
-void EXTI15_10_IRQHandler(void)
+/* exti interrupt handlers */
+/* every handler dispatches the pending lines it serves to the callbacks
+registered with EXTI_Register_Callback */
+RAMFUNC void EXTI0_IRQHandler(void)
 {
-    /* clear pending interrupt bits for exti
-    lines 10-15 */
-    EXTI->PR = BIT(10) | BIT(11) | BIT(12) | BIT(13) | BIT(14) | BIT(15);
+    EXTI_Dispatch(EXTI_LINE_0);
+}
+
+RAMFUNC void EXTI1_IRQHandler(void)
+{
+    EXTI_Dispatch(EXTI_LINE_1);
+}
+
+RAMFUNC void EXTI2_IRQHandler(void)
+{
+    EXTI_Dispatch(EXTI_LINE_2);
+}
+
+RAMFUNC void EXTI3_IRQHandler(void)
+{
+    EXTI_Dispatch(EXTI_LINE_3);
+}
+
+RAMFUNC void EXTI4_IRQHandler(void)
+{
+    EXTI_Dispatch(EXTI_LINE_4);
+}
 
-    GPIO_Toggle(GPIOA, PIN5); // toggle led
-    USART_Transmit(USART2, "led toggled\r\n", 13);
+RAMFUNC void EXTI9_5_IRQHandler(void)
+{
+    EXTI_Dispatch(EXTI_LINES_9_5);
 }
 
-void USART2_IRQHandler(void)
+RAMFUNC void EXTI15_10_IRQHandler(void)
 {
-    /* read byte from usart2 */
-    char str[] = "";
-    USART_Receive_Byte(USART2, str);
+#if LATENCY_TRACE
+    LATENCY_EXTI_Entry();
+#endif
+    PROFILE_BEGIN(EXTI15_10_IRQ);
+    EXTI_Dispatch(EXTI_LINES_15_10);
+    PROFILE_END(EXTI15_10_IRQ);
+}
 
-    /* check if byte received is 't', if so, toggle led and send message */
-    if (*str == 't')
-    {
-        GPIO_Toggle(GPIOA, PIN5);
-        USART_Transmit(USART2, "led toggled\r\n", 13);
-    }
+/* usart2 interrupt handler */
+/* received bytes are buffered by the driver and handled in the main loop */
+RAMFUNC void USART2_IRQHandler(void)
+{
+    PROFILE_BEGIN(USART2_IRQ);
+    USART_IRQ_Handler(USART2);
+    PROFILE_END(USART2_IRQ);
+}
+
+/* usart2 rx dma stream */
+void DMA1_Stream5_IRQHandler(void)
+{
+    DMA_IRQ_Handler(DMA1, DMA_STREAM_5);
+}
+
+/* usart2 tx dma stream */
+void DMA1_Stream6_IRQHandler(void)
+{
+    DMA_IRQ_Handler(DMA1, DMA_STREAM_6);
 }
\ No newline at end of file
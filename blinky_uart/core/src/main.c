@@ -1,61 +1,413 @@
 #include "core/include/main.h"
 
+/* system clock configuration */
+/* the 16 MHz hsi is divided down to 2 MHz and multiplied up to 360 MHz by
+the pll, which gives a 180 MHz system clock. apb1 is limited to 45 MHz and
+apb2 to 90 MHz. the pll could also be fed by the 8 MHz st-link clock on
+the nucleo board (hse in bypass mode) with pllm = 4 */
+static const RCC_Clock_Config clock_config = {
+    .source      = RCC_PLL_SOURCE_HSI,
+    .source_freq = RCC_HSI_FREQ,
+    .hse_bypass  = 0,
+    .pllm        = 8,
+    .plln        = 180,
+    .pllp        = 2,
+    .pllq        = 8,
+    .ahb_div     = 1,
+    .apb1_div    = 4,
+    .apb2_div    = 2
+};
+
 /* initialize clock signals for peripherals used */
 static inline void Clock_Init(void)
 {
+    /* raise the system clock to 180 MHz, stays at 16 MHz if this fails */
+    RCC_Clock_Init(&clock_config);
+
     /* set bit 0 and 2 in the AHB1ENR register to enable 
     the system clock for the GPIOA and GPIOC peripherals */
     RCC->AHB1ENR |= (BIT(0) | BIT(2));
+    /* set bit 21 to enable clock signal for DMA1 peripheral */
+    RCC->AHB1ENR |= BIT(21);
     /* set bit 14 to enable clock signal for SYSCFG peripheral */
     RCC->APB2ENR |= BIT(14);
     /* set bit17 to enable clock signal for USART2 peripheral */
     RCC->APB1ENR |= BIT(17);
+    /* set bit0 to enable clock signal for TIM2 peripheral */
+    RCC->APB1ENR |= BIT(0);
 }
 
+/* per-port pin configuration, generated from the board pin table */
+static const GPIO_Port_Config gpioa_config = GPIO_PORT_CONFIG(BOARD_PIN_TABLE, GPIO_PORT_A);
+static const GPIO_Port_Config gpioc_config = GPIO_PORT_CONFIG(BOARD_PIN_TABLE, GPIO_PORT_C);
+
 /* initialize all gpio pins used */
+/* the pins are listed in core/include/board.h, see there for what is
+connected to them */
+/* the ST-Link generates a virtual com port on PA2 and PA3 that can be
+connected to via a terminal emulator like PuTTY (windows) or cu (unix),
+no serial-to-usb adapter is required */
 static inline void GPIO_Pin_Init(void)
 {
-    /* LD2 is connected to PA5, so set PA5 to output mode */
-    GPIO_Set_Mode(GPIOA, PIN5, GPIO_MODE_OUTPUT);
+    PROFILE_BEGIN(GPIO_PIN_INIT);
+    GPIO_Apply_Port_Config(GPIOA, &gpioa_config);
+    GPIO_Apply_Port_Config(GPIOC, &gpioc_config);
+    PROFILE_END(GPIO_PIN_INIT);
+}
+
+/* led brightness for one breath, loaded into the tim2 compare register by dma */
+static uint32_t led_breathe_table[LED_BREATHE_STEPS];
+
+/* start the led breathing on tim2 channel 1 */
+/* the brightness rises and falls with the square of the step, which looks
+roughly linear to the eye. after this the led costs no cpu time at all */
+static inline void LED_Init(void)
+{
+    TIM_PWM_Init(TIM2, TIM_CHANNEL_1, RCC_Get_APB1_Timer_Freq(), LED_PWM_FREQ);
 
-    /* button 1 is connected to PC13, set it to input mode */
-    GPIO_Set_Mode(GPIOC, PIN13, GPIO_MODE_INPUT);
+    uint32_t period = TIM_PWM_Get_Period(TIM2);
+    uint32_t half = LED_BREATHE_STEPS / 2U;
 
-    /* PA2 and PA3 are connected to the ST-Link via USART */
-    /* the ST-Link generates a virtual com port that can be connected
-    to via a terminal emulator like PuTTY (windows) or cu (unix),
-    no serial-to-usb adapter is required */
+    for (uint32_t i = 0; i < half; i++)
+    {
+        uint32_t level = (i * i * period) / (half * half);
+        led_breathe_table[i] = level;
+        led_breathe_table[LED_BREATHE_STEPS - 1U - i] = level;
+    }
 
-    /* set PA2 to alternate function 7 (usart2 tx) */
-    GPIO_Set_Mode(GPIOA, PIN2, GPIO_MODE_AF);
-    GPIO_Set_AF(GPIOA, PIN2, AF7);
-    /* set PA3 to alternate function 7 (usart2 rx) */
-    GPIO_Set_Mode(GPIOA, PIN3, GPIO_MODE_AF);
-    GPIO_Set_AF(GPIOA, PIN3, AF7);
+    /* tim2 update requests are mapped to DMA1 stream 1 channel 3 */
+    TIM_PWM_DMA_Start(TIM2, TIM_CHANNEL_1, DMA1, DMA_STREAM_1, DMA_CHANNEL_3,
+                      led_breathe_table, LED_BREATHE_STEPS);
+}
+
+/* turn the breathing led on or off */
+/* the output is forced low instead of stopping the timer, so the breath
+continues where it would have been */
+static void LED_Toggle(void)
+{
+    uint32_t primask = critical_section_enter();
+
+    if (TIM_Get_Output_Mode(TIM2, TIM_CHANNEL_1) == TIM_OC_FORCE_INACTIVE)
+    {
+        TIM_Set_Output_Mode(TIM2, TIM_CHANNEL_1, TIM_OC_PWM1);
+    }
+    else
+    {
+        TIM_Set_Output_Mode(TIM2, TIM_CHANNEL_1, TIM_OC_FORCE_INACTIVE);
+    }
+
+    critical_section_exit(primask);
+}
+
+/* button 1 (PC13), debounced */
+static Debounce_Input user_button;
+
+/* handle a debounced button event, the led is toggled on every press */
+static void Button_Event(const Debounce_Event *event)
+{
+    if (event->type == DEBOUNCE_PRESS)
+    {
+        LED_Toggle();
+        LOG("button %u: led toggled", event->input);
+    }
+    else if (event->type == DEBOUNCE_LONG_PRESS)
+    {
+        LOG("button %u: long press", event->input);
+    }
+    else if (event->type == DEBOUNCE_DOUBLE_CLICK)
+    {
+        LOG("button %u: double click", event->input);
+    }
 }
 
 /* initialize exti interrupts */
 static inline void EXTI_Init(void)
 {
-    /* enable exti line 13 to trigger on falling edges */
-    EXTI_Line_Enable(EXTI_LINE_13, EXTI_RISING_EDGE_TRIGGER);
-    /* enable gpio pin PC13 to trigger exti line 13 */
-    SYSCFG_EXTI->EXTICR4 |= (0b0010U << 4UL);
-    /* enable interrupt in nvic for exti line 13 */
+    /* PC13 triggers exti line 13 on both edges, the button pulls it low
+    while pressed */
+    DEBOUNCE_Add(&user_button, GPIO_PORT_C, PIN13, 1, BUTTON_USER);
+#if LATENCY_TRACE
+    /* the latency probe line only needs to be unmasked, the probe is
+    recorded at handler entry so it has no callback */
+    EXTI_Line_Enable(LATENCY_PROBE_LINE, EXTI_SOFTWARE_TRIGGER);
+#endif
+    /* enable interrupt in nvic for exti lines 10-15 */
+    NVIC_SetPriority(EXTI15_10_IRQn, IRQ_PRIORITY_EXTI);
     NVIC_EnableIRQ(EXTI15_10_IRQn);
 }
 
+#if LATENCY_TRACE
+/* periodic exti latency probe, runs in the systick interrupt so the
+measured latency includes the rest of the systick handler */
+static Timer latency_probe;
+
+RAMFUNC static void Latency_Probe(void *arg)
+{
+    (void)arg;
+    LATENCY_EXTI_Probe(LATENCY_PROBE_LINE);
+}
+#endif
+
+#if KERNEL
+/* threads, see THREAD_PRIORITY_EVENTS */
+static Kernel_Thread event_thread;
+static Kernel_Thread monitor_thread;
+static uint32_t event_stack[THREAD_STACK_EVENTS] __attribute__((aligned(8)));
+static uint32_t monitor_stack[THREAD_STACK_MONITOR] __attribute__((aligned(8)));
+
+/* print one thread's unused stack, or only a warning when it is low */
+static void Stack_Report(const char *name, const Kernel_Thread *thread, uint8_t warn_only)
+{
+    uint32_t unused = KERNEL_Stack_Unused(thread);
+
+    if (warn_only && unused >= STACK_MONITOR_LOW) return;
+
+    char line[48];
+    size_t len = FORMAT_String(line, name);
+    len += FORMAT_String(&line[len], warn_only ? " stack low, unused=" : " stack unused=");
+    len += FORMAT_U32(&line[len], unused);
+    len += FORMAT_String(&line[len], "\r\n");
+    USART_Transmit_Async(USART2, line, len);
+}
+
+/* print the context switch cycles and the unused stack of every thread */
+static void Kernel_Report(void)
+{
+    uint32_t last;
+    uint32_t max;
+    KERNEL_Get_Switch_Cycles(&last, &max);
+
+    char line[48];
+    size_t len = FORMAT_String(line, "switch cycles=");
+    len += FORMAT_U32(&line[len], last);
+    len += FORMAT_String(&line[len], " max=");
+    len += FORMAT_U32(&line[len], max);
+    len += FORMAT_String(&line[len], "\r\n");
+    USART_Transmit_Async(USART2, line, len);
+
+    Stack_Report("events", &event_thread, 0);
+    Stack_Report("monitor", &monitor_thread, 0);
+}
+#endif
+
+/* received frame, passed from the usart2 interrupt to Frame_Handler */
+typedef struct
+{
+    uint32_t len;
+    char data[FRAME_MAX_LEN];
+} Frame_Message;
+
+/* frames waiting for Frame_Handler, the blocks are in SRAM2 and the free
+list is built by POOL_Init at runtime */
+static Pool frame_pool;
+static uint32_t frame_storage[POOL_STORAGE_WORDS(sizeof(Frame_Message), FRAME_POOL_BLOCKS)] SRAM2;
+
+/* print the usage of the frame pool */
+static void Pool_Report(void)
+{
+    Pool_Stats stats;
+    POOL_Get_Stats(&frame_pool, &stats);
+
+    char line[64];
+    size_t len = FORMAT_String(line, "frames used=");
+    len += FORMAT_U32(&line[len], stats.used);
+    len += FORMAT_String(&line[len], " max=");
+    len += FORMAT_U32(&line[len], stats.high_water);
+    len += FORMAT_String(&line[len], " failed=");
+    len += FORMAT_U32(&line[len], stats.failed);
+    len += FORMAT_String(&line[len], "\r\n");
+    USART_Transmit_Async(USART2, line, len);
+}
+
+/* handle a frame received on usart2, toggle the led for each 't', print
+the profiling statistics for each 'p', the latency histograms for each
+'l', the kernel statistics for each 'k' and the frame pool usage for each
+'m'. the argument is the Frame_Message, which is freed here */
+static void Frame_Handler(uint32_t arg)
+{
+    Frame_Message *frame = (Frame_Message *)(uintptr_t)arg;
+
+    for (size_t i = 0; i < frame->len; i++)
+    {
+        if (frame->data[i] == 't')
+        {
+            LED_Toggle();
+            LOG("usart2: led toggled");
+        }
+#if PROFILING
+        else if (frame->data[i] == 'p')
+        {
+            PROFILE_Dump(USART2);
+        }
+#endif
+#if LATENCY_TRACE
+        else if (frame->data[i] == 'l')
+        {
+            LATENCY_Dump(USART2);
+        }
+#endif
+#if KERNEL
+        else if (frame->data[i] == 'k')
+        {
+            Kernel_Report();
+        }
+#endif
+        else if (frame->data[i] == 'm')
+        {
+            Pool_Report();
+        }
+    }
+
+    POOL_Free(&frame_pool, frame);
+}
+
+/* handle debounced button events */
+static void Button_Handler(uint32_t arg)
+{
+    (void)arg;
+
+    Debounce_Event event;
+
+    while (DEBOUNCE_Get_Event(&event))
+    {
+        Button_Event(&event);
+    }
+}
+
+/* run deferred software timer callbacks */
+static void Timer_Handler(uint32_t arg)
+{
+    (void)arg;
+    TIMER_Process();
+}
+
+/* send waiting log records */
+static void Log_Handler(uint32_t arg)
+{
+    (void)arg;
+    LOG_Drain(USART2);
+}
+
+/* a frame was received, runs in the usart2 interrupt */
+/* the frame is moved out of the driver into a pool block right away, so
+the driver's receive ring is free again before the handler runs. when
+the pool or the event queue is full the frame is dropped */
+static void Frame_Notify(void)
+{
+    Frame_Message *frame = POOL_Alloc(&frame_pool);
+
+    if (frame == NULL)
+    {
+        USART_Read_Frame(USART2, NULL, 0);
+        LOG("usart2: frame dropped, no free block");
+        return;
+    }
+
+    frame->len = (uint32_t)USART_Read_Frame(USART2, frame->data, sizeof(frame->data));
+
+    if (!SCHED_Post(TASK_PRIORITY_USART, Frame_Handler, (uint32_t)(uintptr_t)frame))
+    {
+        LOG("usart2: frame dropped, event queue full");
+        POOL_Free(&frame_pool, frame);
+    }
+}
+
+/* a button event was queued, runs in the systick interrupt */
+static void Button_Notify(void)
+{
+    SCHED_Post(TASK_PRIORITY_BUTTON, Button_Handler, 0);
+}
+
+/* scheduler idle hook, sleep until an interrupt posts an event */
+/* called with interrupts disabled, an interrupt that posts an event after
+the scheduler checked its queues still wakes up the wfi and runs once the
+scheduler enables interrupts again */
+static void Idle(void)
+{
+    /* deferred timers have no notify hook, they are picked up here */
+    if (TIMER_Deferred_Pending())
+    {
+        SCHED_Post(TASK_PRIORITY_TIMER, Timer_Handler, 0);
+        return;
+    }
+
+    /* log records are sent with dma whenever nothing else is waiting and
+    the usart is not sending anything else. the end of a dma or ring buffer
+    transmit is an interrupt, which wakes up the sleep below */
+    if (LOG_Pending() && USART_DMA_Tx_Ready(USART2))
+    {
+        SCHED_Post(TASK_PRIORITY_LOG, Log_Handler, 0);
+        return;
+    }
+
+#if TICKLESS_IDLE
+    /* skip the systick interrupts until the timer service has work, then
+    catch up with the ticks it missed */
+    TIMER_Advance(SYSTICK_Sleep(TIMER_Ticks_Until_Next()));
+#else
+    wait_for_interrupt();
+#endif
+}
+
+#if KERNEL
+/* the event scheduler, run in a thread instead of from main() */
+static void Event_Thread(void *arg)
+{
+    (void)arg;
+    SCHED_Set_Idle_Hook(Idle);
+    SCHED_Run();
+}
+
+/* warn about threads that come close to overflowing their stack */
+static void Monitor_Thread(void *arg)
+{
+    (void)arg;
+
+    while (1)
+    {
+        KERNEL_Sleep(STACK_MONITOR_INTERVAL);
+        Stack_Report("events", &event_thread, 1);
+        Stack_Report("monitor", &monitor_thread, 1);
+    }
+}
+#endif
+
 int main(void)
 {
+    Vector_Table_Relocate();
     Clock_Init();
     GPIO_Pin_Init();
-    SYSTICK_Init(SYS_FREQ, SYSTICK_SEC); // set systick to seconds
+    LED_Init();
+    /* all 4 priority bits are used for preemption, no subpriorities */
+    NVIC_SetPriorityGrouping(3);
+    NVIC_SetPriority(SysTick_IRQn, IRQ_PRIORITY_SYSTICK);
+    SYSTICK_Init(RCC_Get_HCLK_Freq(), SYSTICK_MS); // set systick to milliseconds
+    SCHED_Init();
+    POOL_Init(&frame_pool, frame_storage, sizeof(Frame_Message), FRAME_POOL_BLOCKS);
+    DEBOUNCE_Set_Notify(Button_Notify);
     EXTI_Init();
-    USART_Init(USART2, SYS_FREQ, 9600); // init usart2 to 9600bps baud rate
+    USART_Init(USART2, RCC_Get_PCLK1_Freq(), 9600); // init usart2 to 9600bps baud rate
+    USART_Set_Frame_Notify(USART2, Frame_Notify);
+    NVIC_SetPriority(USART2_IRQn, IRQ_PRIORITY_USART);
     NVIC_EnableIRQ(USART2_IRQn);
+    /* usart2 rx is DMA1 stream 5 and usart2 tx is DMA1 stream 6, both on channel 4 */
+    USART_DMA_Init(USART2, DMA1, DMA_STREAM_6, DMA_STREAM_5, DMA_CHANNEL_4);
+    NVIC_SetPriority(DMA1_Stream5_IRQn, IRQ_PRIORITY_DMA);
+    NVIC_SetPriority(DMA1_Stream6_IRQn, IRQ_PRIORITY_DMA);
+    NVIC_EnableIRQ(DMA1_Stream5_IRQn);
+    NVIC_EnableIRQ(DMA1_Stream6_IRQn);
+#if LATENCY_TRACE
+    TIMER_Init(&latency_probe, Latency_Probe, NULL, TIMER_RUN_IN_TICK);
+    TIMER_Start(&latency_probe, LATENCY_PROBE_INTERVAL, LATENCY_PROBE_INTERVAL);
+#endif
 
-    while (1)
-    {
-        // do nothing! interrupts do all the work for us
-    }
+    /* all work from here on is done by event handlers, interrupts only post events */
+#if KERNEL
+    KERNEL_Thread_Create(&event_thread, Event_Thread, NULL, event_stack, THREAD_STACK_EVENTS, THREAD_PRIORITY_EVENTS);
+    KERNEL_Thread_Create(&monitor_thread, Monitor_Thread, NULL, monitor_stack, THREAD_STACK_MONITOR, THREAD_PRIORITY_MONITOR);
+    KERNEL_Start();
+#else
+    SCHED_Set_Idle_Hook(Idle);
+    SCHED_Run();
+#endif
 }
\ No newline at end of file
@@ -3,14 +3,79 @@
 /* initial stack pointer */
 extern void _estack(void);
 
+uint32_t startup_cycles;
+
+/* copy a section from flash to sram, dest, src and end must be word aligned */
+static void copy_section(uint32_t *dest, const uint32_t *src, const uint32_t *end)
+{
+#if STARTUP_FAST_INIT
+    /* move 16 bytes per iteration with one load multiple/store multiple pair */
+    while ((uintptr_t)end - (uintptr_t)dest >= 16U)
+    {
+        __asm__ volatile ("ldmia %1!, {r4-r7}\n\tstmia %0!, {r4-r7}"
+                          : "+r" (dest), "+r" (src)
+                          :
+                          : "r4", "r5", "r6", "r7", "memory");
+    }
+#endif
+
+    while (dest < end) *dest++ = *src++;
+}
+
+/* zero-initialize a section, dest and end must be word aligned */
+static void zero_section(uint32_t *dest, const uint32_t *end)
+{
+#if STARTUP_FAST_INIT
+    /* clear 16 bytes per iteration, the compiler turns this into a
+    single store multiple */
+    while ((uintptr_t)end - (uintptr_t)dest >= 16U)
+    {
+        dest[0] = 0;
+        dest[1] = 0;
+        dest[2] = 0;
+        dest[3] = 0;
+        dest += 4;
+    }
+#endif
+
+    while (dest < end) *dest++ = 0;
+}
+
+/* everything that has to happen before main() */
+/* kept out of the naked Reset_Handler so the compiler can give it
+a normal stack frame */
+static __attribute__((noinline)) void startup_init(void)
+{
+    /* enable the fpu before any code can use it */
+    SCB_FPU_Enable();
+
+    /* count cycles from here until main() */
+    DWT_Cycle_Counter_Enable();
+
+    /* turn on the flash ART accelerator (caches and prefetch) first so the
+    rest of startup already runs with it */
+    FLASH_Cache_Reset();
+    FLASH_Cache_Enable();
+    FLASH_Prefetch_Enable();
+
+    /* copy .data section to RAM and zero-initialize .bss section */
+    /* the linker script aligns these symbols to 16 bytes */
+    extern uint32_t _data_start, _data_end, _bss_start, _bss_end, _data_LMA;
+    copy_section(&_data_start, &_data_LMA, &_data_end);
+    /* copy functions that execute from sram (.ramfunc section) */
+    extern uint32_t _ramfunc_start, _ramfunc_end, _ramfunc_LMA;
+    copy_section(&_ramfunc_start, &_ramfunc_LMA, &_ramfunc_end);
+    zero_section(&_bss_start, &_bss_end);
+
+    /* .bss is cleared now, so the result can be stored */
+    startup_cycles = DWT->CYCCNT;
+}
+
 /* reset handler is the very first function that is executed when the
 mcu is is reset */
 __attribute__((naked, noreturn)) void Reset_Handler(void)
 {
-    /* copy .data section to RAM and zero-initialize .bss section */
-    extern long _data_start, _data_end, _bss_start, _bss_end, _data_LMA;
-    for (long *dest = &_data_start, *src = &_data_LMA; dest < &_data_end;) *dest++ = *src++;
-    for (long *dest = &_bss_start; dest < &_bss_end; dest++) *dest = 0;
+    startup_init();
 
     main();
 
@@ -116,6 +181,11 @@ __attribute__((weak, alias("Default_Handler"))) void SPDIF_RX_IRQHandler(void);
 __attribute__((weak, alias("Default_Handler"))) void FMPI2C1_EV_IRQHandler(void);         /* FMPI2C 1 Event               */
 __attribute__((weak, alias("Default_Handler"))) void FMPI2C1_ER_IRQHandler(void);         /* FMPI2C 1 Error               */
 
+/* vector table copy in sram, used once Vector_Table_Relocate is called so that
+handlers can be replaced at runtime with NVIC_SetVector */
+/* VTOR requires the table to be aligned to its size rounded up to a power of two */
+__attribute__((aligned(512))) static void (*ram_vector_table[113])(void);
+
 /* enter an infinite loop to preserve state for debugging
 if a specific interrupt handler is not defined */
 void Default_Handler(void)
@@ -241,4 +311,15 @@ __attribute__((section(".vectortable"))) void (* const vector_table[113])(void)
     SPDIF_RX_IRQHandler,
     FMPI2C1_EV_IRQHandler,
     FMPI2C1_ER_IRQHandler
-};
\ No newline at end of file
+};
+
+/* copy the vector table to sram and make the cpu use that copy */
+void Vector_Table_Relocate(void)
+{
+    for (uint32_t i = 0; i < 113; i++)
+    {
+        ram_vector_table[i] = vector_table[i];
+    }
+
+    SCB_Set_Vector_Table(ram_vector_table);
+}
\ No newline at end of file
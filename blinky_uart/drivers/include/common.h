@@ -8,4 +8,95 @@
 /* macros */
 #define BIT(x) (1UL << (x))
 
+/* host build of the unit tests (make test), 1 when the drivers are
+compiled with the host compiler against fake peripherals. there are no
+sram sections and no interrupts on the host, the tests call the interrupt
+handlers directly, so the cortex-m specific helpers below become no-ops */
+#ifndef HOST_TEST
+#define HOST_TEST 0
+#endif
+
+#if HOST_TEST
+
+#define RAMFUNC
+#define SRAM2
+
+static inline uint32_t critical_section_enter(void)
+{
+    return 0;
+}
+
+static inline void critical_section_exit(uint32_t primask)
+{
+    (void)primask;
+}
+
+static inline void wait_for_interrupt(void)
+{
+}
+
+static inline void data_sync_barrier(void)
+{
+}
+
+static inline void sync_barrier(void)
+{
+}
+
+#else
+
+/* place a function in sram instead of flash, Reset_Handler copies it there */
+/* code in sram runs without flash wait states, so this is meant for
+latency-critical functions such as interrupt handlers. sram is out of
+range of a bl instruction in flash, so the function must be called with
+a long call, which is why public ram functions are also declared RAMFUNC */
+#define RAMFUNC __attribute__((section(".ramfunc"), long_call, noinline))
+
+/* place a variable in SRAM2 instead of SRAM1 */
+/* SRAM2 is not initialized by Reset_Handler, so these variables must be
+initialized at runtime */
+#define SRAM2 __attribute__((section(".sram2")))
+
+/* disable interrupts and return the previous interrupt mask (PRIMASK) */
+/* used to protect short critical sections that are shared between
+interrupts of different priorities */
+static inline uint32_t critical_section_enter(void)
+{
+    uint32_t primask;
+    __asm__ volatile ("mrs %0, primask\n\tcpsid i" : "=r" (primask) : : "memory");
+    return primask;
+}
+
+/* restore the interrupt mask saved by critical_section_enter */
+static inline void critical_section_exit(uint32_t primask)
+{
+    __asm__ volatile ("msr primask, %0" : : "r" (primask) : "memory");
+}
+
+/* sleep until an interrupt is pending */
+/* also wakes up when interrupts are disabled with PRIMASK, the pending
+interrupt then runs once the mask is restored. checking for work and
+sleeping inside a critical section closes the window where an interrupt
+could queue work right before the wfi */
+static inline void wait_for_interrupt(void)
+{
+    __asm__ volatile ("dsb\n\twfi\n\tisb" : : : "memory");
+}
+
+/* wait until every memory access before it has completed (dsb) */
+static inline void data_sync_barrier(void)
+{
+    __asm__ volatile ("dsb" : : : "memory");
+}
+
+/* wait until every memory access before it has completed and refetch the
+instructions after it (dsb, isb), so a write to a system register such as
+VTOR or CPACR is in effect for the next instruction */
+static inline void sync_barrier(void)
+{
+    __asm__ volatile ("dsb\n\tisb" : : : "memory");
+}
+
+#endif // HOST_TEST
+
 #endif // COMMON_H_
\ No newline at end of file
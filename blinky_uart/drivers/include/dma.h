@@ -0,0 +1,118 @@
+#ifndef DMA_H_
+#define DMA_H_
+
+#include "common.h"
+
+/* dma peripheral base addresses */
+#define DMA1_BASE_ADDR 0x40026000
+#define DMA2_BASE_ADDR 0x40026400
+
+/* dma peripheral */
+#define DMA1 ((DMA_Peripheral *) DMA1_BASE_ADDR)
+#define DMA2 ((DMA_Peripheral *) DMA2_BASE_ADDR)
+
+/* registers for a single dma stream */
+typedef struct
+{
+    volatile uint32_t CR;   // DMA stream x configuration register
+    volatile uint32_t NDTR; // DMA stream x number of data register
+    volatile uint32_t PAR;  // DMA stream x peripheral address register
+    volatile uint32_t M0AR; // DMA stream x memory 0 address register
+    volatile uint32_t M1AR; // DMA stream x memory 1 address register
+    volatile uint32_t FCR;  // DMA stream x FIFO control register
+} DMA_Stream_Registers;
+
+/* dma peripheral registers */
+/* each dma controller has 8 streams, the stream registers
+start directly after the interrupt status/clear registers */
+typedef struct
+{
+    volatile uint32_t LISR;        // DMA low interrupt status register (streams 0-3)
+    volatile uint32_t HISR;        // DMA high interrupt status register (streams 4-7)
+    volatile uint32_t LIFCR;       // DMA low interrupt flag clear register
+    volatile uint32_t HIFCR;       // DMA high interrupt flag clear register
+    DMA_Stream_Registers STREAM[8];
+} DMA_Peripheral;
+
+/* dma streams */
+typedef enum
+{
+    DMA_STREAM_0 = 0U,
+    DMA_STREAM_1 = 1U,
+    DMA_STREAM_2 = 2U,
+    DMA_STREAM_3 = 3U,
+    DMA_STREAM_4 = 4U,
+    DMA_STREAM_5 = 5U,
+    DMA_STREAM_6 = 6U,
+    DMA_STREAM_7 = 7U
+} DMA_Stream;
+
+/* dma request channels */
+/* the channel that connects a peripheral to a stream must be looked up
+in the dma request mapping tables of the STM32F446RE reference manual,
+e.g. usart2 rx is DMA1 stream 5 channel 4 and usart2 tx is DMA1 stream 6 channel 4 */
+typedef enum
+{
+    DMA_CHANNEL_0 = 0U,
+    DMA_CHANNEL_1 = 1U,
+    DMA_CHANNEL_2 = 2U,
+    DMA_CHANNEL_3 = 3U,
+    DMA_CHANNEL_4 = 4U,
+    DMA_CHANNEL_5 = 5U,
+    DMA_CHANNEL_6 = 6U,
+    DMA_CHANNEL_7 = 7U
+} DMA_Channel;
+
+/* dma transfer directions */
+typedef enum
+{
+    DMA_PERIPH_TO_MEM = 0U,
+    DMA_MEM_TO_PERIPH = 1U,
+    DMA_MEM_TO_MEM    = 2U
+} DMA_Direction;
+
+/* stream configuration options, these are bits of the stream CR register
+and can be OR'd together */
+typedef enum
+{
+    DMA_CONFIG_TE_IRQ      = BIT(2),  // transfer error interrupt
+    DMA_CONFIG_HT_IRQ      = BIT(3),  // half transfer interrupt
+    DMA_CONFIG_TC_IRQ      = BIT(4),  // transfer complete interrupt
+    DMA_CONFIG_CIRCULAR    = BIT(8),  // restart automatically when NDTR reaches 0
+    DMA_CONFIG_PERIPH_INC  = BIT(9),  // increment peripheral address
+    DMA_CONFIG_MEM_INC     = BIT(10), // increment memory address
+    DMA_CONFIG_PSIZE_16    = BIT(11), // peripheral data size half-word (default byte)
+    DMA_CONFIG_PSIZE_32    = BIT(12), // peripheral data size word
+    DMA_CONFIG_MSIZE_16    = BIT(13), // memory data size half-word (default byte)
+    DMA_CONFIG_MSIZE_32    = BIT(14), // memory data size word
+    DMA_CONFIG_PRIO_MEDIUM = BIT(16), // stream priority medium (default low)
+    DMA_CONFIG_PRIO_HIGH   = BIT(17)  // stream priority high
+} DMA_Config;
+
+/* stream interrupt flags, as passed to a dma callback */
+typedef enum
+{
+    DMA_FLAG_FE  = BIT(0), // fifo error
+    DMA_FLAG_DME = BIT(2), // direct mode error
+    DMA_FLAG_TE  = BIT(3), // transfer error
+    DMA_FLAG_HT  = BIT(4), // half transfer
+    DMA_FLAG_TC  = BIT(5)  // transfer complete
+} DMA_Flag;
+
+/* called from the stream's interrupt handler with the flags that were set */
+typedef void (*DMA_Callback)(uint32_t flags, void *arg);
+
+/* configure a dma stream, the stream is left disabled */
+void DMA_Stream_Init(DMA_Peripheral *, DMA_Stream, DMA_Channel, DMA_Direction, uint32_t);
+/* start a transfer of count items between a peripheral register and memory */
+void DMA_Stream_Start(DMA_Peripheral *, DMA_Stream, volatile void *, const volatile void *, uint16_t);
+/* stop a stream and wait for it to be disabled */
+void DMA_Stream_Stop(DMA_Peripheral *, DMA_Stream);
+/* number of items left in the current transfer */
+uint16_t DMA_Stream_Remaining(DMA_Peripheral *, DMA_Stream);
+/* register the callback run by DMA_IRQ_Handler for a stream */
+void DMA_Set_Callback(DMA_Peripheral *, DMA_Stream, DMA_Callback, void *);
+/* service stream interrupts, must be called from the stream's irq handler */
+void DMA_IRQ_Handler(DMA_Peripheral *, DMA_Stream);
+
+#endif // DMA_H_
\ No newline at end of file
@@ -0,0 +1,33 @@
+#ifndef DWT_H_
+#define DWT_H_
+
+#include "common.h"
+
+/* base address for the cortex-m4 data watchpoint and trace unit */
+#define DWT_BASE_ADDR 0xE0001000
+
+/* address of the debug exception and monitor control register,
+bit24 (TRCENA) must be set before the dwt can be used */
+#define DWT_DEMCR_ADDR 0xE000EDFC
+
+/* dwt peripheral */
+#define DWT ((DWT_Peripheral *) DWT_BASE_ADDR)
+#define DWT_DEMCR (*(volatile uint32_t *) DWT_DEMCR_ADDR)
+
+/* dwt registers used for cycle counting */
+typedef struct
+{
+    volatile uint32_t CTRL;     // DWT control register
+    volatile uint32_t CYCCNT;   // DWT cycle count register
+    volatile uint32_t CPICNT;   // DWT CPI count register
+    volatile uint32_t EXCCNT;   // DWT exception overhead count register
+    volatile uint32_t SLEEPCNT; // DWT sleep count register
+    volatile uint32_t LSUCNT;   // DWT LSU count register
+    volatile uint32_t FOLDCNT;  // DWT folded-instruction count register
+    volatile uint32_t PCSR;     // DWT program counter sample register
+} DWT_Peripheral;
+
+/* reset the cycle counter to 0 and start it */
+void DWT_Cycle_Counter_Enable(void);
+
+#endif // DWT_H_
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define EXTI_H_
 
 #include "common.h"
+#include "gpio.h"
 
 /* exti peripheral base address */
 #define EXTI_PERIPH_BASE_ADDR 0x40013C00
@@ -24,15 +25,20 @@ typedef struct
 
 /* syscfg registers that are used
 for configuring exti */
+/* EXTICR[n] selects the port of lines 4n to 4n+3, 4 bits per line */
 typedef struct
 {
              uint32_t UNUSED0[2];
-    volatile uint32_t EXTICR1; // SYSCFG external interrupt configuration register 1
-    volatile uint32_t EXTICR2; // SYSCFG external interrupt configuration register 2
-    volatile uint32_t EXTICR3; // SYSCFG external interrupt configuration register 3
-    volatile uint32_t EXTICR4; // SYSCFG external interrupt configuration register 4
+    volatile uint32_t EXTICR[4]; // SYSCFG external interrupt configuration registers 1-4
 } SYSCFG_EXTI_Peripheral;
 
+/* number of exti lines */
+#define EXTI_LINES 23U
+
+/* lines served by each exti interrupt */
+#define EXTI_LINES_9_5   (BIT(5) | BIT(6) | BIT(7) | BIT(8) | BIT(9))
+#define EXTI_LINES_15_10 (BIT(10) | BIT(11) | BIT(12) | BIT(13) | BIT(14) | BIT(15))
+
 /* enums for each of the 23 exti interrupt lines */
 typedef enum
 {
@@ -67,9 +73,27 @@ typedef enum
     EXTI_RISING_EDGE_TRIGGER,
     EXTI_FALLING_EDGE_TRIGGER,
     EXTI_RISING_FALLING_EDGE_TRIGGER,
+    EXTI_SOFTWARE_TRIGGER, // no edge detection, only EXTI_Software_Trigger
 } EXTI_Trigger;
 
+/* called from the exti interrupt when a line is pending */
+typedef void (*EXTI_Callback)(void *);
+
 /* enable an exti line */
 void EXTI_Line_Enable(EXTI_Line, EXTI_Trigger);
+/* generate an interrupt on an exti line from software */
+RAMFUNC void EXTI_Software_Trigger(EXTI_Line);
+/* stop an exti line from generating interrupts, its trigger configuration is kept */
+RAMFUNC void EXTI_Mask_Line(EXTI_Line);
+/* let a masked exti line generate interrupts again */
+RAMFUNC void EXTI_Unmask_Line(EXTI_Line);
+/* clear the pending bit of an exti line */
+RAMFUNC void EXTI_Clear_Pending(EXTI_Line);
+/* select the gpio port that drives an exti line (lines 0-15) */
+void EXTI_Set_Source(EXTI_Line, GPIO_Port);
+/* register the callback run by EXTI_Dispatch for a line */
+void EXTI_Register_Callback(EXTI_Line, EXTI_Callback, void *);
+/* clear and run the callbacks of the pending lines in a mask, called from the exti irq handlers */
+RAMFUNC void EXTI_Dispatch(uint32_t);
 
 #endif // EXTI_H_
\ No newline at end of file
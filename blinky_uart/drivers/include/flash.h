@@ -0,0 +1,38 @@
+#ifndef FLASH_H_
+#define FLASH_H_
+
+#include "common.h"
+
+/* base address for the flash interface */
+#define FLASH_PERIPH_BASE_ADDR 0x40023C00
+
+/* flash interface peripheral */
+#define FLASH ((FLASH_Peripheral *) FLASH_PERIPH_BASE_ADDR)
+
+/* flash interface registers */
+typedef struct
+{
+    volatile uint32_t ACR;     // FLASH access control register
+    volatile uint32_t KEYR;    // FLASH key register
+    volatile uint32_t OPTKEYR; // FLASH option key register
+    volatile uint32_t SR;      // FLASH status register
+    volatile uint32_t CR;      // FLASH control register
+    volatile uint32_t OPTCR;   // FLASH option control register
+} FLASH_Peripheral;
+
+/* set the number of flash wait states (latency) */
+void FLASH_Set_Latency(uint32_t);
+/* get the number of flash wait states currently in use */
+uint32_t FLASH_Get_Latency(void);
+/* enable the ART accelerator instruction and data caches */
+void FLASH_Cache_Enable(void);
+/* disable the ART accelerator instruction and data caches */
+void FLASH_Cache_Disable(void);
+/* invalidate the instruction and data caches */
+void FLASH_Cache_Reset(void);
+/* enable the flash prefetch buffer */
+void FLASH_Prefetch_Enable(void);
+/* disable the flash prefetch buffer */
+void FLASH_Prefetch_Disable(void);
+
+#endif // FLASH_H_
\ No newline at end of file
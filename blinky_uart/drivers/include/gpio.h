@@ -20,6 +20,9 @@ where each instance is placed at the base address for its respective peripheral
 #define GPIOB ((GPIO_Peripheral *) GPIOB_BASE_ADDR)
 #define GPIOC ((GPIO_Peripheral *) GPIOC_BASE_ADDR)
 
+/* gpio peripheral of a GPIO_Port */
+#define GPIO_PORT_PERIPH(port) ((GPIO_Peripheral *) (GPIO_PERIPH_BASE_ADDR + 0x0400UL * (port)))
+
 /* gpio peripheral struct, holds all the gpio peripheral registers */
 typedef struct
 {
@@ -35,6 +38,14 @@ typedef struct
     volatile uint32_t AFRH;    // GPIO alternate function register high
 } GPIO_Peripheral;
 
+/* gpio ports, numbered in address order */
+typedef enum
+{
+    GPIO_PORT_A = 0U,
+    GPIO_PORT_B = 1U,
+    GPIO_PORT_C = 2U
+} GPIO_Port;
+
 /* generic io pins */
 /* each pin has the corresponding bit set, i.e. pin 4 -> bit 4 set */
 typedef enum
@@ -97,15 +108,121 @@ typedef enum
     AF15 = 0xFU,
 } GPIO_AF;
 
+/* gpio output speeds, faster edges cost more power and noise */
+typedef enum
+{
+    GPIO_SPEED_LOW    = 0U,
+    GPIO_SPEED_MEDIUM = 1U,
+    GPIO_SPEED_FAST   = 2U,
+    GPIO_SPEED_HIGH   = 3U
+} GPIO_Speed;
+
+/* gpio pull-up/pull-down resistors */
+typedef enum
+{
+    GPIO_PULL_NONE = 0U,
+    GPIO_PULL_UP   = 1U,
+    GPIO_PULL_DOWN = 2U
+} GPIO_Pull;
+
+/* gpio output types */
+typedef enum
+{
+    GPIO_OUTPUT_PUSH_PULL  = 0U,
+    GPIO_OUTPUT_OPEN_DRAIN = 1U
+} GPIO_Output_Type;
+
+/* configuration of a whole port, as a mask of the bits to change and
+their new value for each configuration register */
+/* built at compile time from a pin table with GPIO_PORT_CONFIG */
+typedef struct
+{
+    uint32_t moder_mask;
+    uint32_t moder;
+    uint32_t otyper_mask;
+    uint32_t otyper;
+    uint32_t ospeedr_mask;
+    uint32_t ospeedr;
+    uint32_t pupdr_mask;
+    uint32_t pupdr;
+    uint32_t afrl_mask;
+    uint32_t afrl;
+    uint32_t afrh_mask;
+    uint32_t afrh;
+} GPIO_Port_Config;
+
+/* pin table entries are expanded as
+PIN(target, port, pinno, mode, af, speed, pull, otype), every macro
+below returns its bits for pins of the target port and 0 otherwise */
+#define GPIO_CFG_BITS(target, port, value) ((port) == (target) ? (uint32_t)(value) : 0U)
+
+#define GPIO_CFG_MODER_MASK(target, port, pinno, mode, af, speed, pull, otype) \
+    | GPIO_CFG_BITS(target, port, 3UL << ((pinno) * 2U))
+#define GPIO_CFG_MODER(target, port, pinno, mode, af, speed, pull, otype) \
+    | GPIO_CFG_BITS(target, port, (uint32_t)(mode) << ((pinno) * 2U))
+#define GPIO_CFG_OTYPER_MASK(target, port, pinno, mode, af, speed, pull, otype) \
+    | GPIO_CFG_BITS(target, port, 1UL << (pinno))
+#define GPIO_CFG_OTYPER(target, port, pinno, mode, af, speed, pull, otype) \
+    | GPIO_CFG_BITS(target, port, (uint32_t)(otype) << (pinno))
+#define GPIO_CFG_OSPEEDR_MASK(target, port, pinno, mode, af, speed, pull, otype) \
+    | GPIO_CFG_BITS(target, port, 3UL << ((pinno) * 2U))
+#define GPIO_CFG_OSPEEDR(target, port, pinno, mode, af, speed, pull, otype) \
+    | GPIO_CFG_BITS(target, port, (uint32_t)(speed) << ((pinno) * 2U))
+#define GPIO_CFG_PUPDR_MASK(target, port, pinno, mode, af, speed, pull, otype) \
+    | GPIO_CFG_BITS(target, port, 3UL << ((pinno) * 2U))
+#define GPIO_CFG_PUPDR(target, port, pinno, mode, af, speed, pull, otype) \
+    | GPIO_CFG_BITS(target, port, (uint32_t)(pull) << ((pinno) * 2U))
+#define GPIO_CFG_AFRL_MASK(target, port, pinno, mode, af, speed, pull, otype) \
+    | GPIO_CFG_BITS(target, port, (pinno) < 8U ? 15UL << (((pinno) & 7U) * 4U) : 0U)
+#define GPIO_CFG_AFRL(target, port, pinno, mode, af, speed, pull, otype) \
+    | GPIO_CFG_BITS(target, port, (pinno) < 8U ? (uint32_t)(af) << (((pinno) & 7U) * 4U) : 0U)
+#define GPIO_CFG_AFRH_MASK(target, port, pinno, mode, af, speed, pull, otype) \
+    | GPIO_CFG_BITS(target, port, (pinno) >= 8U ? 15UL << (((pinno) & 7U) * 4U) : 0U)
+#define GPIO_CFG_AFRH(target, port, pinno, mode, af, speed, pull, otype) \
+    | GPIO_CFG_BITS(target, port, (pinno) >= 8U ? (uint32_t)(af) << (((pinno) & 7U) * 4U) : 0U)
+
+/* build the GPIO_Port_Config of one port from a pin table, the table is
+a macro taking an entry macro and an argument passed to every entry:
+table(PIN, arg) expands to PIN(arg, port, pinno, ...) for each pin */
+/* everything folds into constants, so a static const config costs no code */
+#define GPIO_PORT_CONFIG(table, port) {                         \
+    .moder_mask   = 0U table(GPIO_CFG_MODER_MASK, port),        \
+    .moder        = 0U table(GPIO_CFG_MODER, port),             \
+    .otyper_mask  = 0U table(GPIO_CFG_OTYPER_MASK, port),       \
+    .otyper       = 0U table(GPIO_CFG_OTYPER, port),            \
+    .ospeedr_mask = 0U table(GPIO_CFG_OSPEEDR_MASK, port),      \
+    .ospeedr      = 0U table(GPIO_CFG_OSPEEDR, port),           \
+    .pupdr_mask   = 0U table(GPIO_CFG_PUPDR_MASK, port),        \
+    .pupdr        = 0U table(GPIO_CFG_PUPDR, port),             \
+    .afrl_mask    = 0U table(GPIO_CFG_AFRL_MASK, port),         \
+    .afrl         = 0U table(GPIO_CFG_AFRL, port),              \
+    .afrh_mask    = 0U table(GPIO_CFG_AFRH_MASK, port),         \
+    .afrh         = 0U table(GPIO_CFG_AFRH, port)               \
+}
+
 /* set the mode of a gpio pin */
 void GPIO_Set_Mode(GPIO_Peripheral *, GPIO_Pin, GPIO_Pin_Mode);
 /* set alternate function for a gpio pin */
 void GPIO_Set_AF(GPIO_Peripheral *, GPIO_Pin, GPIO_AF);
+/* set the output speed of a gpio pin */
+void GPIO_Set_Speed(GPIO_Peripheral *, GPIO_Pin, GPIO_Speed);
+/* set the output type of a gpio pin */
+void GPIO_Set_Output_Type(GPIO_Peripheral *, GPIO_Pin, GPIO_Output_Type);
+/* set the pull-up/pull-down resistor of a gpio pin */
+void GPIO_Set_Pull(GPIO_Peripheral *, GPIO_Pin, GPIO_Pull);
 /* write to a gpio pin that is in output mode */
 void GPIO_Write(GPIO_Peripheral *, GPIO_Pin, GPIO_Pin_State);
 /* read from gpio pin(s) that are in input mode */
 GPIO_Pin_State GPIO_Read(GPIO_Peripheral *, GPIO_Pin);
 /* toggle a single gpio pin */
 void GPIO_Toggle(GPIO_Peripheral *, GPIO_Pin);
+/* write the pins of a port selected by a mask in one atomic write */
+void GPIO_Write_Port(GPIO_Peripheral *, uint16_t, uint16_t);
+/* toggle the pins of a port selected by a mask */
+void GPIO_Toggle_Port(GPIO_Peripheral *, uint16_t);
+/* read the pins of a port selected by a mask */
+uint16_t GPIO_Read_Port(GPIO_Peripheral *, uint16_t);
+/* configure all pins of a port listed in a GPIO_Port_Config */
+void GPIO_Apply_Port_Config(GPIO_Peripheral *, const GPIO_Port_Config *);
 
 #endif // GPIO_DRIVER_H_
\ No newline at end of file
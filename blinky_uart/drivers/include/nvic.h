@@ -11,26 +11,32 @@
 
 /* nvic peripheral typedef */
 /* the cortex-m4 nvic is capable of handling up to 496 different
-interrupts. however, ST only implements 96 interrupts on STM32F446RE.
-the remaining 400 interrupts in the nvic are unused. each 32-bit
-register handles 32 interrupts, so we only need to use the first 3
+interrupts. however, ST only implements 97 interrupts (0-96) on STM32F446RE.
+the remaining interrupts in the nvic are unused. each 32-bit
+register handles 32 interrupts, so we only need to use the first 4
 of each register, the rest remain reserved (unused) */
+/* the priority registers hold one 8-bit field per interrupt and can be
+accessed a byte at a time */
 typedef struct
 {
-    volatile uint32_t ISER[3];       // NVIC interrupt set enable register
-             uint32_t RESERVED0[29];
-    volatile uint32_t ICER[3];       // NVIC interrupt clear enable register
-             uint32_t RESERVED1[29];
-    volatile uint32_t ISPR[3];       // NVIC interrupt set pending register
-             uint32_t RESERVED2[29];
-    volatile uint32_t ICPR[3];       // NVIC interrupt clear pending register
-             uint32_t RESERVED3[29];
-    volatile uint32_t IABR[3];       // NVIC interrupt active bit register
-             uint32_t RESERVED4[29];
-             uint32_t RESERVED5[32];
-    volatile uint32_t IPR[3];        // NVIC interrupt priority register
+    volatile uint32_t ISER[4];       // NVIC interrupt set enable register
+             uint32_t RESERVED0[28];
+    volatile uint32_t ICER[4];       // NVIC interrupt clear enable register
+             uint32_t RESERVED1[28];
+    volatile uint32_t ISPR[4];       // NVIC interrupt set pending register
+             uint32_t RESERVED2[28];
+    volatile uint32_t ICPR[4];       // NVIC interrupt clear pending register
+             uint32_t RESERVED3[28];
+    volatile uint32_t IABR[4];       // NVIC interrupt active bit register
+             uint32_t RESERVED4[60];
+    volatile uint8_t  IPR[240];      // NVIC interrupt priority register
 } NVIC_Peripheral;
 
+/* number of priority bits implemented by the STM32F446RE, only the upper
+4 bits of each 8-bit priority field are used, giving 16 priority levels
+(0 is the highest priority, 15 the lowest) */
+#define NVIC_PRIO_BITS 4U
+
 typedef enum
 {
     /******  Cortex-M4 Processor Exceptions Numbers ************************************************************/
@@ -134,5 +140,29 @@ typedef enum
 
 /* enable an interrupt in the nvic */
 void NVIC_EnableIRQ(IRQn_Type);
+/* disable an interrupt in the nvic */
+void NVIC_DisableIRQ(IRQn_Type);
+/* set an interrupt pending */
+void NVIC_SetPendingIRQ(IRQn_Type);
+/* clear a pending interrupt */
+void NVIC_ClearPendingIRQ(IRQn_Type);
+/* returns 1 if an interrupt is pending */
+uint32_t NVIC_GetPendingIRQ(IRQn_Type);
+/* returns 1 if an interrupt is active (its handler is running or was preempted) */
+uint32_t NVIC_GetActive(IRQn_Type);
+/* set the priority of an interrupt or cortex-m4 system exception */
+void NVIC_SetPriority(IRQn_Type, uint32_t);
+/* get the priority of an interrupt or cortex-m4 system exception */
+uint32_t NVIC_GetPriority(IRQn_Type);
+/* set how the priority bits are split into preemption priority and subpriority */
+void NVIC_SetPriorityGrouping(uint32_t);
+/* get the priority grouping */
+uint32_t NVIC_GetPriorityGrouping(void);
+/* combine a preemption priority and subpriority for NVIC_SetPriority */
+uint32_t NVIC_EncodePriority(uint32_t, uint32_t, uint32_t);
+/* replace the handler of an interrupt, the vector table must be in sram */
+void NVIC_SetVector(IRQn_Type, void (*)(void));
+/* get the handler of an interrupt from the active vector table */
+void (*NVIC_GetVector(IRQn_Type))(void);
 
 #endif // NVIC_H_
\ No newline at end of file
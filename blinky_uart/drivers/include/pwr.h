@@ -0,0 +1,32 @@
+#ifndef PWR_H_
+#define PWR_H_
+
+#include "common.h"
+
+/* base address for the pwr peripheral */
+#define PWR_PERIPH_BASE_ADDR 0x40007000
+
+/* pwr peripheral */
+#define PWR ((PWR_Peripheral *) PWR_PERIPH_BASE_ADDR)
+
+/* pwr peripheral registers */
+typedef struct
+{
+    volatile uint32_t CR;  // PWR power control register
+    volatile uint32_t CSR; // PWR power control/status register
+} PWR_Peripheral;
+
+/* main regulator voltage scaling, higher scales allow higher hclk frequencies */
+typedef enum
+{
+    PWR_VOLTAGE_SCALE_3 = 1U, // hclk up to 120 MHz
+    PWR_VOLTAGE_SCALE_2 = 2U, // hclk up to 144 MHz (168 MHz with over-drive)
+    PWR_VOLTAGE_SCALE_1 = 3U  // hclk up to 168 MHz (180 MHz with over-drive)
+} PWR_Voltage_Scale;
+
+/* set the regulator voltage scale, only takes effect while the pll is off */
+void PWR_Set_Voltage_Scale(PWR_Voltage_Scale);
+/* enable over-drive mode, required for hclk above 168 MHz */
+void PWR_Overdrive_Enable(void);
+
+#endif // PWR_H_
\ No newline at end of file
@@ -50,4 +50,69 @@ typedef struct
     volatile uint32_t DCKCFGR2;     // RCC Dedicated Clocks configuration register 2
 } RCC_Peripheral;
 
+/* frequency of the internal 16 MHz rc oscillator, the clock used after reset */
+#define RCC_HSI_FREQ 16000000U
+
+/* maximum bus frequencies with over-drive enabled (voltage scale 1) */
+#define RCC_MAX_HCLK_FREQ  180000000U
+#define RCC_MAX_PCLK1_FREQ 45000000U
+#define RCC_MAX_PCLK2_FREQ 90000000U
+
+/* hclk frequency above which over-drive must be enabled */
+#define RCC_OVERDRIVE_FREQ 168000000U
+
+/* clock source for the main pll */
+typedef enum
+{
+    RCC_PLL_SOURCE_HSI = 0U, // internal 16 MHz rc oscillator
+    RCC_PLL_SOURCE_HSE = 1U  // external crystal or clock signal
+} RCC_PLL_Source;
+
+/* clock tree configuration */
+/* SYSCLK = source_freq / pllm * plln / pllp, HCLK = SYSCLK / ahb_div,
+PCLK1 = HCLK / apb1_div and PCLK2 = HCLK / apb2_div */
+typedef struct
+{
+    RCC_PLL_Source source;
+    uint32_t source_freq; // hsi or hse frequency in hz
+    uint8_t hse_bypass;   // 1 if hse is driven by an external clock signal instead of a crystal
+    uint32_t pllm;        // vco input divider, 2-63 (vco input must be 1-2 MHz)
+    uint32_t plln;        // vco multiplier, 50-432 (vco output must be 100-432 MHz)
+    uint32_t pllp;        // system clock divider, 2, 4, 6 or 8
+    uint32_t pllq;        // usb/sdio clock divider, 2-15
+    uint32_t ahb_div;     // 1, 2, 4, 8, 16, 64, 128, 256 or 512
+    uint32_t apb1_div;    // 1, 2, 4, 8 or 16
+    uint32_t apb2_div;    // 1, 2, 4, 8 or 16
+} RCC_Clock_Config;
+
+/* bus frequencies in hz */
+typedef struct
+{
+    uint32_t sysclk;
+    uint32_t hclk;
+    uint32_t pclk1;
+    uint32_t pclk2;
+} RCC_Clocks;
+
+/* status returned by the clock functions */
+typedef enum
+{
+    RCC_OK    = 0U,
+    RCC_ERROR = 1U  // configuration is out of range, clocks are left unchanged
+} RCC_Status;
+
+/* compute the bus frequencies of a clock configuration without touching the hardware */
+RCC_Status RCC_Calc_Clocks(const RCC_Clock_Config *, RCC_Clocks *);
+/* number of flash wait states needed for an hclk frequency (2.7-3.6V supply) */
+uint32_t RCC_Calc_Flash_Latency(uint32_t);
+/* switch the system clock to the pll */
+RCC_Status RCC_Clock_Init(const RCC_Clock_Config *);
+/* current bus frequencies */
+uint32_t RCC_Get_SYSCLK_Freq(void);
+uint32_t RCC_Get_HCLK_Freq(void);
+uint32_t RCC_Get_PCLK1_Freq(void);
+uint32_t RCC_Get_PCLK2_Freq(void);
+/* clock of the timers on apb1 */
+uint32_t RCC_Get_APB1_Timer_Freq(void);
+
 #endif // RCC_DRIVER_H_
\ No newline at end of file
@@ -0,0 +1,43 @@
+#ifndef SCB_H_
+#define SCB_H_
+
+#include "common.h"
+
+/* base address for the cortex-m4 system control block */
+#define SCB_BASE_ADDR 0xE000ED00
+
+/* address of the coprocessor access control register, bits 20-23 give
+access to the fpu (coprocessors 10 and 11) */
+#define SCB_CPACR_ADDR 0xE000ED88
+
+/* system control block */
+#define SCB ((SCB_Peripheral *) SCB_BASE_ADDR)
+#define SCB_CPACR (*(volatile uint32_t *) SCB_CPACR_ADDR)
+
+/* system control block registers */
+typedef struct
+{
+    volatile uint32_t CPUID;    // CPUID base register
+    volatile uint32_t ICSR;     // interrupt control and state register
+    volatile uint32_t VTOR;     // vector table offset register
+    volatile uint32_t AIRCR;    // application interrupt and reset control register
+    volatile uint32_t SCR;      // system control register
+    volatile uint32_t CCR;      // configuration and control register
+    volatile uint8_t  SHPR[12]; // system handler priority registers, one byte per exception 4-15
+    volatile uint32_t SHCSR;    // system handler control and state register
+    volatile uint32_t CFSR;     // configurable fault status register
+    volatile uint32_t HFSR;     // hardfault status register
+    volatile uint32_t DFSR;     // debug fault status register
+    volatile uint32_t MMFAR;    // memmanage fault address register
+    volatile uint32_t BFAR;     // busfault address register
+    volatile uint32_t AFSR;     // auxiliary fault status register
+} SCB_Peripheral;
+
+/* point the vector table offset register at a vector table */
+void SCB_Set_Vector_Table(const void *);
+/* give privileged and unprivileged code full access to the fpu */
+void SCB_FPU_Enable(void);
+/* make the pendsv exception pending */
+RAMFUNC void SCB_Trigger_PendSV(void);
+
+#endif // SCB_H_
\ No newline at end of file
@@ -9,6 +9,9 @@
 /* systick timer peripheral */
 #define SYSTICK ((SYSTICK_Peripheral *) SYSTICK_BASE_ADDR)
 
+/* largest reload value, the systick timer is 24-bit */
+#define SYSTICK_MAX_RELOAD 0xffffffUL
+
 /* systick peripheral struct */
 typedef struct
 {
@@ -29,10 +32,20 @@ typedef enum
 } SYSTICK_Time_Interval;
 
 /* handler for systick interrupts */
-void SYSTICK_Inc_Ticks(void);
+RAMFUNC void SYSTICK_Inc_Ticks(void);
 /* systick timer initializer */
 void SYSTICK_Init(uint32_t, SYSTICK_Time_Interval);
 /* systick execution delay */
 void SYSTICK_Delay(uint32_t);
+/* clock cycles per tick */
+RAMFUNC uint32_t SYSTICK_Get_Tick_Cycles(void);
+/* clock cycles since the current tick started */
+RAMFUNC uint32_t SYSTICK_Get_Tick_Elapsed(void);
+/* number of ticks since initialization */
+RAMFUNC uint64_t SYSTICK_Get_Ticks(void);
+/* clock cycles since initialization, read from the tick count and the current counter value */
+uint64_t SYSTICK_Now(void);
+/* tickless sleep for up to a number of ticks, returns the number of ticks skipped */
+uint32_t SYSTICK_Sleep(uint32_t);
 
 #endif // SYSTICK_H_
\ No newline at end of file
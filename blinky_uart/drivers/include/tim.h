@@ -0,0 +1,83 @@
+#ifndef TIM_H_
+#define TIM_H_
+
+#include "common.h"
+#include "dma.h"
+
+/* base addresses for the general purpose timers on apb1 */
+#define TIM2_BASE_ADDR 0x40000000
+#define TIM3_BASE_ADDR 0x40000400
+#define TIM4_BASE_ADDR 0x40000800
+#define TIM5_BASE_ADDR 0x40000C00
+
+/* timer peripherals */
+/* tim2 and tim5 have 32-bit counters, tim3 and tim4 16-bit counters */
+#define TIM2 ((TIM_Peripheral *) TIM2_BASE_ADDR)
+#define TIM3 ((TIM_Peripheral *) TIM3_BASE_ADDR)
+#define TIM4 ((TIM_Peripheral *) TIM4_BASE_ADDR)
+#define TIM5 ((TIM_Peripheral *) TIM5_BASE_ADDR)
+
+/* general purpose timer registers */
+typedef struct
+{
+    volatile uint32_t CR1;    // TIM control register 1
+    volatile uint32_t CR2;    // TIM control register 2
+    volatile uint32_t SMCR;   // TIM slave mode control register
+    volatile uint32_t DIER;   // TIM dma/interrupt enable register
+    volatile uint32_t SR;     // TIM status register
+    volatile uint32_t EGR;    // TIM event generation register
+    volatile uint32_t CCMR1;  // TIM capture/compare mode register 1
+    volatile uint32_t CCMR2;  // TIM capture/compare mode register 2
+    volatile uint32_t CCER;   // TIM capture/compare enable register
+    volatile uint32_t CNT;    // TIM counter
+    volatile uint32_t PSC;    // TIM prescaler
+    volatile uint32_t ARR;    // TIM auto-reload register
+             uint32_t UNUSED0;
+    volatile uint32_t CCR[4]; // TIM capture/compare registers 1-4
+             uint32_t UNUSED1;
+    volatile uint32_t DCR;    // TIM dma control register
+    volatile uint32_t DMAR;   // TIM dma address for full transfer
+    volatile uint32_t OR;     // TIM option register
+} TIM_Peripheral;
+
+/* capture/compare channels */
+typedef enum
+{
+    TIM_CHANNEL_1 = 0U,
+    TIM_CHANNEL_2 = 1U,
+    TIM_CHANNEL_3 = 2U,
+    TIM_CHANNEL_4 = 3U
+} TIM_Channel;
+
+/* output compare modes (OCxM) */
+typedef enum
+{
+    TIM_OC_FORCE_INACTIVE = 4U, // output forced low
+    TIM_OC_FORCE_ACTIVE   = 5U, // output forced high
+    TIM_OC_PWM1           = 6U  // output high while the counter is below CCR
+} TIM_OC_Mode;
+
+/* largest pwm period (ARR + 1) used, the same for 16-bit and 32-bit timers */
+/* a compare value of a whole period is needed for a duty cycle of 100%,
+so the period itself must fit in 16 bits and not only ARR */
+#define TIM_MAX_PERIOD 0xFFFFUL
+
+/* set up a channel for pwm output at a frequency, the duty cycle starts at 0 */
+void TIM_PWM_Init(TIM_Peripheral *, TIM_Channel, uint32_t, uint32_t);
+/* change the pwm frequency, keeping the duty cycle of every channel */
+void TIM_PWM_Set_Frequency(TIM_Peripheral *, uint32_t, uint32_t);
+/* set the duty cycle of a channel in 1/1000 */
+void TIM_PWM_Set_Duty(TIM_Peripheral *, TIM_Channel, uint32_t);
+/* number of counter steps in one pwm period */
+uint32_t TIM_PWM_Get_Period(TIM_Peripheral *);
+/* set the output compare mode of a channel */
+void TIM_Set_Output_Mode(TIM_Peripheral *, TIM_Channel, TIM_OC_Mode);
+/* get the output compare mode of a channel */
+TIM_OC_Mode TIM_Get_Output_Mode(TIM_Peripheral *, TIM_Channel);
+/* load the compare value of a channel from a table by dma on every update event */
+void TIM_PWM_DMA_Start(TIM_Peripheral *, TIM_Channel, DMA_Peripheral *, DMA_Stream, DMA_Channel,
+                       const uint32_t *, uint16_t);
+/* stop loading compare values by dma */
+void TIM_PWM_DMA_Stop(TIM_Peripheral *, DMA_Peripheral *, DMA_Stream);
+
+#endif // TIM_H_
\ No newline at end of file
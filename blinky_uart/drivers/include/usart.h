@@ -2,6 +2,7 @@
 #define USART_H_
 
 #include "common.h"
+#include "dma.h"
 
 /* usart peripheral base addresses */
 #define USART1_BASE_ADDR 0x40011000
@@ -31,10 +32,66 @@ typedef struct
     volatile uint32_t GTPR; // USART guard time and prescaler register
 } USART_Peripheral;
 
+/* maximum number of usart peripherals that can use the
+interrupt-driven (asynchronous) api at the same time */
+#define USART_MAX_INSTANCES 2U
+
+/* size of the transmit ring buffer for each usart in bytes */
+/* must be a power of two so indices can be wrapped with a mask */
+#define USART_TX_BUFFER_SIZE 256U
+
+/* size of the receive ring buffer for each usart in bytes */
+/* must be a power of two so indices can be wrapped with a mask */
+#define USART_RX_BUFFER_SIZE 256U
+
+/* maximum number of received frames waiting to be read, must be a power of two */
+#define USART_RX_MAX_FRAMES 16U
+
+/* receive error counters */
+typedef struct
+{
+    uint32_t overrun; // a byte arrived before the previous one was read (ORE)
+    uint32_t framing; // stop bit not detected (FE)
+    uint32_t noise;   // noise detected on a received byte (NF)
+    uint32_t dropped; // bytes discarded because the receive ring buffer was full
+} USART_Error_Counts;
+
+/* called from the dma interrupt once a dma transmit has finished */
+typedef void (*USART_Tx_Callback)(void);
+/* called from the dma interrupt with each half of the circular receive buffer
+as soon as that half has been filled */
+typedef void (*USART_Rx_Callback)(const char *, size_t);
+/* called from the usart interrupt each time a complete frame was received */
+typedef void (*USART_Frame_Notify)(void);
+
 /* initialize a usart peripheral */
-void USART_Init(USART_Peripheral *, uint32_t, uint16_t);
-/* write a buffer to a usart */
+void USART_Init(USART_Peripheral *, uint32_t, uint32_t);
+/* write a buffer to a usart, blocks until every byte has been sent */
 void USART_Transmit(USART_Peripheral *, char *, size_t);
+/* queue a buffer for interrupt-driven transmission, returns the number of bytes queued */
+size_t USART_Transmit_Async(USART_Peripheral *, const char *, size_t);
+/* number of bytes that fit into the transmit ring buffer, 0 if the usart was not initialized */
+size_t USART_Tx_Space(USART_Peripheral *);
+/* service usart interrupts, must be called from the usart's irq handler */
+RAMFUNC void USART_IRQ_Handler(USART_Peripheral *);
+/* copy the oldest complete received frame into a buffer, returns its length or 0 */
+size_t USART_Read_Frame(USART_Peripheral *, char *, size_t);
+/* returns 1 if a complete received frame is waiting to be read */
+uint8_t USART_Frame_Available(USART_Peripheral *);
+/* register a function called whenever a complete frame was received */
+void USART_Set_Frame_Notify(USART_Peripheral *, USART_Frame_Notify);
+/* get the receive error counters of a usart */
+void USART_Get_Errors(USART_Peripheral *, USART_Error_Counts *);
+/* bind dma streams to a usart for zero-copy transfers */
+void USART_DMA_Init(USART_Peripheral *, DMA_Peripheral *, DMA_Stream, DMA_Stream, DMA_Channel);
+/* send a caller-owned buffer with dma, returns the number of bytes being sent */
+size_t USART_DMA_Transmit(USART_Peripheral *, const char *, size_t, USART_Tx_Callback);
+/* returns 1 if no dma transmit is in progress and the transmit ring buffer is empty */
+uint8_t USART_DMA_Tx_Ready(USART_Peripheral *);
+/* continuously receive into a caller-owned circular buffer with dma */
+void USART_DMA_Receive(USART_Peripheral *, char *, size_t, USART_Rx_Callback);
+/* stop a dma receive started by USART_DMA_Receive */
+void USART_DMA_Receive_Stop(USART_Peripheral *);
 /* recieve from a usart */
 void USART_Receive_Byte(USART_Peripheral *, char *);
 
@@ -0,0 +1,112 @@
+#include "drivers/include/dma.h"
+
+/* callbacks registered for each stream of DMA1 and DMA2 */
+typedef struct
+{
+    DMA_Callback callback;
+    void *arg;
+} stream_callback;
+
+static stream_callback callbacks[2][8];
+
+/* all 5 interrupt flags of a stream */
+#define DMA_FLAG_ALL (DMA_FLAG_FE | DMA_FLAG_DME | DMA_FLAG_TE | DMA_FLAG_HT | DMA_FLAG_TC)
+
+/* bit offset of a stream's flags within LISR/HISR and LIFCR/HIFCR */
+/* streams 0-3 use the low registers, streams 4-7 use the high registers
+with the same layout */
+static inline uint32_t flag_shift(DMA_Stream stream)
+{
+    static const uint8_t shifts[4] = { 0U, 6U, 16U, 22U };
+    return shifts[stream & 3U];
+}
+
+/* read the interrupt flags of a stream */
+static inline uint32_t read_flags(DMA_Peripheral *dmax, DMA_Stream stream)
+{
+    uint32_t isr = (stream < DMA_STREAM_4) ? dmax->LISR : dmax->HISR;
+    return (isr >> flag_shift(stream)) & DMA_FLAG_ALL;
+}
+
+/* clear interrupt flags of a stream */
+static inline void clear_flags(DMA_Peripheral *dmax, DMA_Stream stream, uint32_t flags)
+{
+    if (stream < DMA_STREAM_4)
+    {
+        dmax->LIFCR = flags << flag_shift(stream);
+    }
+    else
+    {
+        dmax->HIFCR = flags << flag_shift(stream);
+    }
+}
+
+/* configure a dma stream */
+/* config is a combination of DMA_Config options */
+void DMA_Stream_Init(DMA_Peripheral *dmax, DMA_Stream stream, DMA_Channel channel,
+                     DMA_Direction direction, uint32_t config)
+{
+    DMA_Stream_Stop(dmax, stream);
+
+    /* channel select is bits 25-27, direction is bits 6-7 */
+    dmax->STREAM[stream].CR = ((uint32_t)channel << 25) | ((uint32_t)direction << 6) | config;
+
+    /* use direct mode (fifo disabled) so every request moves one item */
+    dmax->STREAM[stream].FCR = 0;
+}
+
+/* start a transfer on a configured stream */
+/* the memory buffer is used in place and must stay valid until the
+transfer completes */
+void DMA_Stream_Start(DMA_Peripheral *dmax, DMA_Stream stream, volatile void *periph,
+                      const volatile void *mem, uint16_t count)
+{
+    DMA_Stream_Stop(dmax, stream);
+
+    /* the stream does not start if flags from a previous transfer are still set */
+    clear_flags(dmax, stream, DMA_FLAG_ALL);
+
+    dmax->STREAM[stream].PAR = (uint32_t)(uintptr_t)periph;
+    dmax->STREAM[stream].M0AR = (uint32_t)(uintptr_t)mem;
+    dmax->STREAM[stream].NDTR = count;
+
+    /* set bit0 to enable the stream */
+    dmax->STREAM[stream].CR |= BIT(0);
+}
+
+/* disable a stream, the enable bit stays set until the current
+transfer has actually stopped */
+void DMA_Stream_Stop(DMA_Peripheral *dmax, DMA_Stream stream)
+{
+    dmax->STREAM[stream].CR &= ~BIT(0);
+    while (dmax->STREAM[stream].CR & BIT(0)) {}
+}
+
+/* number of items left before the stream reaches the end of its buffer */
+uint16_t DMA_Stream_Remaining(DMA_Peripheral *dmax, DMA_Stream stream)
+{
+    return (uint16_t)dmax->STREAM[stream].NDTR;
+}
+
+/* register a callback for a stream */
+void DMA_Set_Callback(DMA_Peripheral *dmax, DMA_Stream stream, DMA_Callback callback, void *arg)
+{
+    stream_callback *cb = &callbacks[(dmax == DMA1) ? 0 : 1][stream];
+
+    cb->callback = callback;
+    cb->arg = arg;
+}
+
+/* clear the stream's flags and hand them to its callback */
+void DMA_IRQ_Handler(DMA_Peripheral *dmax, DMA_Stream stream)
+{
+    uint32_t flags = read_flags(dmax, stream);
+    stream_callback *cb = &callbacks[(dmax == DMA1) ? 0 : 1][stream];
+
+    clear_flags(dmax, stream, flags);
+
+    if (cb->callback != NULL)
+    {
+        cb->callback(flags, cb->arg);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,10 @@
+#include "drivers/include/dwt.h"
+
+/* start the 32-bit cycle counter, it counts core clock cycles and
+wraps around every 2^32 cycles (about 23.8 seconds at 180 MHz) */
+void DWT_Cycle_Counter_Enable(void)
+{
+    DWT_DEMCR |= BIT(24); // enable the dwt (TRCENA)
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= BIT(0);  // enable the cycle counter (CYCCNTENA)
+}
\ No newline at end of file
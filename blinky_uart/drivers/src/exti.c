@@ -1,5 +1,18 @@
 #include "drivers/include/exti.h"
 
+/* callback of every line, run by EXTI_Dispatch */
+static struct
+{
+    EXTI_Callback callback;
+    void *arg;
+} callbacks[EXTI_LINES];
+
+/* number of a single exti line, the line has exactly one bit set */
+static inline uint32_t line_number(EXTI_Line line)
+{
+    return (uint32_t)__builtin_ctz((uint32_t)line);
+}
+
 /* exti line enable with trigger selection */
 void EXTI_Line_Enable(EXTI_Line line, EXTI_Trigger trigger)
 {
@@ -20,4 +33,91 @@ void EXTI_Line_Enable(EXTI_Line line, EXTI_Trigger trigger)
         EXTI->RTSR |= line; 
         EXTI->FTSR |= line; 
     }
+}
+
+/* generate an interrupt on an enabled exti line from software */
+/* the pending bit is set as if the configured edge was detected, and is
+cleared through the pending register like a hardware trigger */
+RAMFUNC void EXTI_Software_Trigger(EXTI_Line line)
+{
+    EXTI->SWIER = line; // writing 0 to the other lines has no effect
+}
+
+/* stop an exti line from generating interrupts */
+/* IMR is shared by all lines and may be changed from interrupts of
+different priorities, so it is updated with interrupts disabled */
+RAMFUNC void EXTI_Mask_Line(EXTI_Line line)
+{
+    uint32_t primask = critical_section_enter();
+    EXTI->IMR &= ~(uint32_t)line;
+    critical_section_exit(primask);
+}
+
+/* let a masked exti line generate interrupts again */
+RAMFUNC void EXTI_Unmask_Line(EXTI_Line line)
+{
+    uint32_t primask = critical_section_enter();
+    EXTI->IMR |= line;
+    critical_section_exit(primask);
+}
+
+/* clear the pending bit of an exti line */
+RAMFUNC void EXTI_Clear_Pending(EXTI_Line line)
+{
+    EXTI->PR = line; // writing 1 clears the bit, 0 has no effect
+}
+
+/* select the gpio port that drives an exti line */
+/* only lines 0-15 are connected to gpio pins, line n is driven by pin n
+of the selected port */
+void EXTI_Set_Source(EXTI_Line line, GPIO_Port port)
+{
+    uint32_t lineno = line_number(line);
+
+    if (lineno > 15) return;
+
+    uint32_t shift = (lineno % 4U) * 4U;
+    volatile uint32_t *exticr = &SYSCFG_EXTI->EXTICR[lineno / 4U];
+
+    *exticr = (*exticr & ~(15UL << shift)) | ((uint32_t)port << shift);
+}
+
+/* register the callback run by EXTI_Dispatch for a line, NULL removes it */
+void EXTI_Register_Callback(EXTI_Line line, EXTI_Callback callback, void *arg)
+{
+    uint32_t lineno = line_number(line);
+
+    if (lineno >= EXTI_LINES) return;
+
+    uint32_t primask = critical_section_enter();
+
+    callbacks[lineno].callback = callback;
+    callbacks[lineno].arg = arg;
+
+    critical_section_exit(primask);
+}
+
+/* clear and run the callbacks of the pending lines in a mask */
+/* each exti irq handler passes the lines it serves. only lines that are
+pending and unmasked are handled, and their pending bits are cleared
+before the callbacks run so an edge during a callback is not lost. the
+lines are found with count leading zeros, so the cost depends on the
+number of pending lines and not on the size of the mask */
+RAMFUNC void EXTI_Dispatch(uint32_t lines)
+{
+    uint32_t pending = EXTI->PR & EXTI->IMR & lines;
+
+    /* the pending bits are cleared by writing 1 to them */
+    EXTI->PR = pending;
+
+    while (pending != 0)
+    {
+        uint32_t lineno = 31U - (uint32_t)__builtin_clz(pending);
+        pending &= ~BIT(lineno);
+
+        if (callbacks[lineno].callback != NULL)
+        {
+            callbacks[lineno].callback(callbacks[lineno].arg);
+        }
+    }
 }
\ No newline at end of file
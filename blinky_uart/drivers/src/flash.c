@@ -0,0 +1,52 @@
+#include "drivers/include/flash.h"
+
+/* set the flash latency (bits 0-3 of the access control register) */
+/* the new value must be read back before the cpu clock is raised,
+so wait until the register reports it */
+void FLASH_Set_Latency(uint32_t wait_states)
+{
+    FLASH->ACR = (FLASH->ACR & ~15UL) | (wait_states & 15UL);
+    while ((FLASH->ACR & 15UL) != (wait_states & 15UL)) {}
+}
+
+/* get the current flash latency */
+uint32_t FLASH_Get_Latency(void)
+{
+    return FLASH->ACR & 15UL;
+}
+
+/* set bit9 (ICEN) and bit10 (DCEN) to enable the instruction and data caches */
+/* with the caches enabled, code running from flash executes with
+zero wait states on a cache hit even at 180 MHz */
+void FLASH_Cache_Enable(void)
+{
+    FLASH->ACR |= BIT(9) | BIT(10);
+}
+
+/* clear bit9 and bit10 to disable the instruction and data caches */
+void FLASH_Cache_Disable(void)
+{
+    FLASH->ACR &= ~(BIT(9) | BIT(10));
+}
+
+/* invalidate the caches by pulsing bit11 (ICRST) and bit12 (DCRST) */
+/* the caches can only be reset while they are disabled, so they are
+disabled first and left disabled */
+void FLASH_Cache_Reset(void)
+{
+    FLASH_Cache_Disable();
+    FLASH->ACR |= BIT(11) | BIT(12);
+    FLASH->ACR &= ~(BIT(11) | BIT(12));
+}
+
+/* set bit8 (PRFTEN) to fetch the next flash line while the current one executes */
+void FLASH_Prefetch_Enable(void)
+{
+    FLASH->ACR |= BIT(8);
+}
+
+/* clear bit8 to disable the prefetch buffer */
+void FLASH_Prefetch_Disable(void)
+{
+    FLASH->ACR &= ~BIT(8);
+}
\ No newline at end of file
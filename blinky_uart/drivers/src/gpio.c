@@ -3,20 +3,11 @@
 /* calculate number of a gpio pin (pinno)
 which is a whole value in [0, 15] */
 /* for example, if pin = PIN5, then pinno = 5 */
+/* the pin has exactly one bit set, so its number is the count of trailing
+zeros, which compiles to rbit + clz instead of a loop */
 static inline uint8_t calc_pinno(GPIO_Pin pin)
 {
-    uint8_t pinno = 0;
-
-    for (uint8_t i = 0; i < 16; i++)
-    {
-        if ((pin & (1 << i)) == pin)
-        {
-            pinno = i;
-            break;
-        }
-    }
-
-    return pinno;
+    return (uint8_t)__builtin_ctz((uint32_t)pin);
 }
 
 /* set the mode of a gpio pin */
@@ -31,6 +22,8 @@ void GPIO_Set_Mode(GPIO_Peripheral *gpiox, GPIO_Pin pin, GPIO_Pin_Mode mode)
 
 /* sets the alternate function for a given GPIO port and pin */
 /* this function assumes the pin is already placed in AF mode */
+/* pins 0-7 are configured in AFRL and pins 8-15 in AFRH, both hold
+4 bits per pin starting with the lowest pin of their half */
 void GPIO_Set_AF(GPIO_Peripheral *gpiox, GPIO_Pin pin, GPIO_AF af)
 {
     uint8_t pinno = calc_pinno(pin);
@@ -42,11 +35,39 @@ void GPIO_Set_AF(GPIO_Peripheral *gpiox, GPIO_Pin pin, GPIO_AF af)
     }
     else
     {
-        gpiox->AFRH &= ~(15U << (pinno * 4)); // clear bits before setting them
-        gpiox->AFRH |= (af << (pinno * 4));
+        gpiox->AFRH &= ~(15U << ((pinno - 8) * 4)); // clear bits before setting them
+        gpiox->AFRH |= (af << ((pinno - 8) * 4));
     }
 }
 
+/* set the output speed of a gpio pin */
+/* only matters for pins in output or AF mode */
+void GPIO_Set_Speed(GPIO_Peripheral *gpiox, GPIO_Pin pin, GPIO_Speed speed)
+{
+    uint8_t pinno = calc_pinno(pin);
+
+    gpiox->OSPEEDR &= ~(3U << (pinno * 2)); // clear bits before setting them
+    gpiox->OSPEEDR |= (speed << (pinno * 2));
+}
+
+/* set the output type of a gpio pin to push-pull or open-drain */
+void GPIO_Set_Output_Type(GPIO_Peripheral *gpiox, GPIO_Pin pin, GPIO_Output_Type otype)
+{
+    uint8_t pinno = calc_pinno(pin);
+
+    gpiox->OTYPER &= ~(1U << pinno); // clear bit before setting it
+    gpiox->OTYPER |= (otype << pinno);
+}
+
+/* set the pull-up/pull-down resistor of a gpio pin */
+void GPIO_Set_Pull(GPIO_Peripheral *gpiox, GPIO_Pin pin, GPIO_Pull pull)
+{
+    uint8_t pinno = calc_pinno(pin);
+
+    gpiox->PUPDR &= ~(3U << (pinno * 2)); // clear bits before setting them
+    gpiox->PUPDR |= (pull << (pinno * 2));
+}
+
 /* write a 1 (set) or a 0 (reset) to a gpio pin */
 /* this function assumes the pin is already placed in output mode */
 void GPIO_Write(GPIO_Peripheral *gpiox, GPIO_Pin pin, GPIO_Pin_State pinstate)
@@ -80,12 +101,53 @@ GPIO_Pin_State GPIO_Read(GPIO_Peripheral *gpiox, GPIO_Pin pin)
 /* toggles a single gpio output pin */
 void GPIO_Toggle(GPIO_Peripheral *gpiox, GPIO_Pin pin)
 {
-    if ((gpiox->ODR & pin) == pin)
-    {
-        gpiox->BSRR = ((uint32_t)pin << 16);
-    }
-    else
-    {
-        gpiox->BSRR = pin;
-    }
+    GPIO_Toggle_Port(gpiox, (uint16_t)pin);
+}
+
+/* write several pins of a port at once, pins set in mask take the
+value of the same bit in value, other pins are left alone */
+/* the lower half of BSRR sets pins and the upper half resets them, so
+this is a single store that an interrupt cannot split */
+void GPIO_Write_Port(GPIO_Peripheral *gpiox, uint16_t mask, uint16_t value)
+{
+    uint32_t set = (uint32_t)(mask & value);
+    uint32_t reset = (uint32_t)(mask & (uint16_t)~value);
+
+    gpiox->BSRR = (reset << 16) | set;
+}
+
+/* toggle several pins of a port at once */
+/* the new state depends on ODR, so reading it and writing BSRR is done with
+interrupts disabled, an interrupt writing the same pins in between would
+otherwise be undone */
+void GPIO_Toggle_Port(GPIO_Peripheral *gpiox, uint16_t mask)
+{
+    uint32_t primask = critical_section_enter();
+
+    uint32_t odr = gpiox->ODR;
+    gpiox->BSRR = ((odr & mask) << 16) | (~odr & mask);
+
+    critical_section_exit(primask);
+}
+
+/* read several pins of a port at once */
+/* returns the input data register limited to the pins set in mask, all
+pins are sampled at the same time */
+uint16_t GPIO_Read_Port(GPIO_Peripheral *gpiox, uint16_t mask)
+{
+    return (uint16_t)(gpiox->IDR & mask);
+}
+
+/* apply a port configuration with a single read-modify-write per register */
+/* the mode register is written last, so a pin only switches to output or
+alternate function mode once its output type, speed, pull and alternate
+function are in place */
+void GPIO_Apply_Port_Config(GPIO_Peripheral *gpiox, const GPIO_Port_Config *config)
+{
+    gpiox->OTYPER = (gpiox->OTYPER & ~config->otyper_mask) | config->otyper;
+    gpiox->OSPEEDR = (gpiox->OSPEEDR & ~config->ospeedr_mask) | config->ospeedr;
+    gpiox->PUPDR = (gpiox->PUPDR & ~config->pupdr_mask) | config->pupdr;
+    gpiox->AFRL = (gpiox->AFRL & ~config->afrl_mask) | config->afrl;
+    gpiox->AFRH = (gpiox->AFRH & ~config->afrh_mask) | config->afrh;
+    gpiox->MODER = (gpiox->MODER & ~config->moder_mask) | config->moder;
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "drivers/include/nvic.h"
+#include "drivers/include/scb.h"
 
 /* enable a irq in the nvic */
 /* same implementation as ARM CMSIS for cortex m4 */
@@ -8,4 +9,141 @@ void NVIC_EnableIRQ(IRQn_Type IRQn)
     {
         NVIC->ISER[(((uint32_t)IRQn) >> 5UL)] = (uint32_t)(1UL << (((uint32_t)IRQn) & 0x1FUL));
     }
+}
+
+/* disable a irq in the nvic */
+/* the barriers make sure the interrupt can no longer fire once this returns */
+void NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+    if ((int32_t)(IRQn) >= 0)
+    {
+        NVIC->ICER[(((uint32_t)IRQn) >> 5UL)] = (uint32_t)(1UL << (((uint32_t)IRQn) & 0x1FUL));
+        sync_barrier();
+    }
+}
+
+/* set a irq pending, its handler runs as soon as its priority allows */
+void NVIC_SetPendingIRQ(IRQn_Type IRQn)
+{
+    if ((int32_t)(IRQn) >= 0)
+    {
+        NVIC->ISPR[(((uint32_t)IRQn) >> 5UL)] = (uint32_t)(1UL << (((uint32_t)IRQn) & 0x1FUL));
+    }
+}
+
+/* clear a pending irq */
+void NVIC_ClearPendingIRQ(IRQn_Type IRQn)
+{
+    if ((int32_t)(IRQn) >= 0)
+    {
+        NVIC->ICPR[(((uint32_t)IRQn) >> 5UL)] = (uint32_t)(1UL << (((uint32_t)IRQn) & 0x1FUL));
+    }
+}
+
+/* check if a irq is pending */
+uint32_t NVIC_GetPendingIRQ(IRQn_Type IRQn)
+{
+    if ((int32_t)(IRQn) >= 0)
+    {
+        return (NVIC->ISPR[(((uint32_t)IRQn) >> 5UL)] >> (((uint32_t)IRQn) & 0x1FUL)) & 1UL;
+    }
+
+    return 0;
+}
+
+/* check if a irq is active */
+uint32_t NVIC_GetActive(IRQn_Type IRQn)
+{
+    if ((int32_t)(IRQn) >= 0)
+    {
+        return (NVIC->IABR[(((uint32_t)IRQn) >> 5UL)] >> (((uint32_t)IRQn) & 0x1FUL)) & 1UL;
+    }
+
+    return 0;
+}
+
+/* set the priority of a irq or system exception, 0 (highest) to 15 (lowest) */
+/* system exceptions (negative IRQn) are configured in the SHPR registers of
+the system control block, where byte 0 belongs to exception 4 (memmanage)
+and byte 11 to exception 15 (systick) */
+void NVIC_SetPriority(IRQn_Type IRQn, uint32_t priority)
+{
+    uint8_t value = (uint8_t)((priority << (8U - NVIC_PRIO_BITS)) & 0xFFUL);
+
+    if ((int32_t)(IRQn) >= 0)
+    {
+        NVIC->IPR[(uint32_t)IRQn] = value;
+    }
+    else
+    {
+        SCB->SHPR[(((uint32_t)IRQn) & 0xFUL) - 4UL] = value;
+    }
+}
+
+/* get the priority of a irq or system exception */
+uint32_t NVIC_GetPriority(IRQn_Type IRQn)
+{
+    if ((int32_t)(IRQn) >= 0)
+    {
+        return (uint32_t)NVIC->IPR[(uint32_t)IRQn] >> (8U - NVIC_PRIO_BITS);
+    }
+    else
+    {
+        return (uint32_t)SCB->SHPR[(((uint32_t)IRQn) & 0xFUL) - 4UL] >> (8U - NVIC_PRIO_BITS);
+    }
+}
+
+/* set the priority grouping field (PRIGROUP, bits 8-10) of the AIRCR register */
+/* with 4 priority bits, grouping 0-3 means 4 bits of preemption priority
+and no subpriority, 4 means 3 bits preemption and 1 bit subpriority, and
+so on up to 7 which means no preemption at all */
+/* writes to AIRCR are ignored unless the upper 16 bits hold the key 0x05FA */
+void NVIC_SetPriorityGrouping(uint32_t group)
+{
+    uint32_t aircr = SCB->AIRCR & ~(0xFFFFUL << 16 | 7UL << 8);
+
+    SCB->AIRCR = aircr | (0x05FAUL << 16) | ((group & 7UL) << 8);
+}
+
+/* get the priority grouping */
+uint32_t NVIC_GetPriorityGrouping(void)
+{
+    return (SCB->AIRCR >> 8) & 7UL;
+}
+
+/* combine a preemption priority and a subpriority into a priority value
+for NVIC_SetPriority, given the priority grouping in use */
+/* same implementation as ARM CMSIS for cortex m4 */
+uint32_t NVIC_EncodePriority(uint32_t group, uint32_t preempt, uint32_t sub)
+{
+    group &= 7UL;
+
+    uint32_t preempt_bits = ((7UL - group) > NVIC_PRIO_BITS) ? NVIC_PRIO_BITS : (7UL - group);
+    uint32_t sub_bits = ((group + NVIC_PRIO_BITS) < 7UL) ? 0UL : (group + NVIC_PRIO_BITS - 7UL);
+
+    return ((preempt & ((1UL << preempt_bits) - 1UL)) << sub_bits) |
+           (sub & ((1UL << sub_bits) - 1UL));
+}
+
+/* the first 16 entries of the vector table are the cortex-m4 exceptions,
+so interrupt n is entry n + 16 (exceptions have negative IRQn values) */
+static inline void (**active_vector_table(void))(void)
+{
+    return (void (**)(void))(uintptr_t)SCB->VTOR;
+}
+
+/* replace the handler of an interrupt or exception */
+/* only works once the vector table has been relocated to sram */
+void NVIC_SetVector(IRQn_Type IRQn, void (*handler)(void))
+{
+    active_vector_table()[(int32_t)IRQn + 16] = handler;
+
+    /* make sure the new handler is used by the next exception */
+    data_sync_barrier();
+}
+
+/* get the handler of an interrupt or exception */
+void (*NVIC_GetVector(IRQn_Type IRQn))(void)
+{
+    return active_vector_table()[(int32_t)IRQn + 16];
 }
\ No newline at end of file
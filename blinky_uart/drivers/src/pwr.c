@@ -0,0 +1,24 @@
+#include "drivers/include/pwr.h"
+
+/* set the voltage scale (bits 14-15 of the control register) */
+/* the clock for the pwr peripheral must be enabled before calling this */
+void PWR_Set_Voltage_Scale(PWR_Voltage_Scale scale)
+{
+    PWR->CR = (PWR->CR & ~(3UL << 14)) | ((uint32_t)scale << 14);
+}
+
+/* enable over-drive and switch the regulator to it */
+/* the pll must already be locked, and the system clock must not be
+switched to the higher frequency until this returns */
+void PWR_Overdrive_Enable(void)
+{
+    /* set bit16 to enable over-drive, bit16 in the status register
+    is set once it is ready */
+    PWR->CR |= BIT(16);
+    while ((PWR->CSR & BIT(16)) == 0) {}
+
+    /* set bit17 to switch the 1.2V domain to over-drive, bit17 in the
+    status register is set once the switch is complete */
+    PWR->CR |= BIT(17);
+    while ((PWR->CSR & BIT(17)) == 0) {}
+}
\ No newline at end of file
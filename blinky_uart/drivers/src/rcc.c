@@ -0,0 +1,207 @@
+#include "drivers/include/rcc.h"
+#include "drivers/include/flash.h"
+#include "drivers/include/pwr.h"
+
+/* bus frequencies currently in use, the mcu runs from the hsi after reset */
+static RCC_Clocks clocks = {
+    .sysclk = RCC_HSI_FREQ,
+    .hclk   = RCC_HSI_FREQ,
+    .pclk1  = RCC_HSI_FREQ,
+    .pclk2  = RCC_HSI_FREQ
+};
+
+/* encode an ahb divider for the HPRE field, returns 0xFF if invalid */
+/* 1 -> 0b0000, 2 -> 0b1000, 4 -> 0b1001, ... 16 -> 0b1011,
+64 -> 0b1100, ... 512 -> 0b1111 (there is no divide by 32) */
+static uint32_t encode_ahb_div(uint32_t div)
+{
+    switch (div)
+    {
+        case 1:   return 0x0U;
+        case 2:   return 0x8U;
+        case 4:   return 0x9U;
+        case 8:   return 0xAU;
+        case 16:  return 0xBU;
+        case 64:  return 0xCU;
+        case 128: return 0xDU;
+        case 256: return 0xEU;
+        case 512: return 0xFU;
+        default:  return 0xFFU;
+    }
+}
+
+/* encode an apb divider for the PPRE1/PPRE2 fields, returns 0xFF if invalid */
+/* 1 -> 0b000, 2 -> 0b100, 4 -> 0b101, 8 -> 0b110, 16 -> 0b111 */
+static uint32_t encode_apb_div(uint32_t div)
+{
+    switch (div)
+    {
+        case 1:  return 0x0U;
+        case 2:  return 0x4U;
+        case 4:  return 0x5U;
+        case 8:  return 0x6U;
+        case 16: return 0x7U;
+        default: return 0xFFU;
+    }
+}
+
+/* compute and validate the bus frequencies of a clock configuration */
+/* pure function so the divider math can be checked off-target */
+RCC_Status RCC_Calc_Clocks(const RCC_Clock_Config *config, RCC_Clocks *out)
+{
+    if (config->pllm < 2 || config->pllm > 63) return RCC_ERROR;
+    if (config->plln < 50 || config->plln > 432) return RCC_ERROR;
+    if (config->pllp < 2 || config->pllp > 8 || (config->pllp & 1U)) return RCC_ERROR;
+    if (config->pllq < 2 || config->pllq > 15) return RCC_ERROR;
+    if (encode_ahb_div(config->ahb_div) == 0xFFU) return RCC_ERROR;
+    if (encode_apb_div(config->apb1_div) == 0xFFU) return RCC_ERROR;
+    if (encode_apb_div(config->apb2_div) == 0xFFU) return RCC_ERROR;
+
+    uint32_t vco_in = config->source_freq / config->pllm;
+    if (vco_in < 1000000U || vco_in > 2000000U) return RCC_ERROR;
+
+    uint64_t vco_out = (uint64_t)vco_in * config->plln;
+    if (vco_out < 100000000U || vco_out > 432000000U) return RCC_ERROR;
+
+    RCC_Clocks result;
+    result.sysclk = (uint32_t)(vco_out / config->pllp);
+    result.hclk = result.sysclk / config->ahb_div;
+    result.pclk1 = result.hclk / config->apb1_div;
+    result.pclk2 = result.hclk / config->apb2_div;
+
+    if (result.hclk > RCC_MAX_HCLK_FREQ) return RCC_ERROR;
+    if (result.pclk1 > RCC_MAX_PCLK1_FREQ) return RCC_ERROR;
+    if (result.pclk2 > RCC_MAX_PCLK2_FREQ) return RCC_ERROR;
+
+    *out = result;
+    return RCC_OK;
+}
+
+/* flash wait states for a given hclk, one wait state per 30 MHz
+when the supply is between 2.7V and 3.6V */
+uint32_t RCC_Calc_Flash_Latency(uint32_t hclk)
+{
+    if (hclk == 0) return 0;
+
+    return (hclk - 1U) / 30000000U;
+}
+
+/* configure the pll from a clock configuration and switch the system clock to it */
+/* order matters here: the voltage scale can only change while the pll is
+off, over-drive must be ready before the clock is raised above 168 MHz, and
+the flash latency must be raised before the clock is, or flash reads fail */
+RCC_Status RCC_Clock_Init(const RCC_Clock_Config *config)
+{
+    RCC_Clocks next;
+
+    if (RCC_Calc_Clocks(config, &next) != RCC_OK) return RCC_ERROR;
+
+    /* if the pll is already driving the system clock (SWS, bits 2-3 = 0b10),
+    fall back to the hsi so the pll can be reconfigured */
+    if (((RCC->CFGR >> 2) & 3U) == 2U)
+    {
+        RCC->CR |= BIT(0);                     // hsi on
+        while ((RCC->CR & BIT(1)) == 0) {}     // wait for hsi ready
+        RCC->CFGR &= ~3UL;                     // SW = hsi
+        while (((RCC->CFGR >> 2) & 3U) != 0) {}
+    }
+
+    /* clear bit24 to turn the pll off and wait for bit25 (ready) to clear */
+    RCC->CR &= ~BIT(24);
+    while (RCC->CR & BIT(25)) {}
+
+    if (config->source == RCC_PLL_SOURCE_HSE)
+    {
+        /* set bit18 if hse is an external clock (e.g. the st-link mco on nucleo boards) */
+        if (config->hse_bypass)
+        {
+            RCC->CR |= BIT(18);
+        }
+
+        /* set bit16 to turn on hse, bit17 is set once it is stable */
+        RCC->CR |= BIT(16);
+        while ((RCC->CR & BIT(17)) == 0) {}
+    }
+
+    /* set bit28 to enable the clock for the pwr peripheral, then
+    select voltage scale 1 for the highest frequencies */
+    RCC->APB1ENR |= BIT(28);
+    PWR_Set_Voltage_Scale(PWR_VOLTAGE_SCALE_1);
+
+    /* PLLM bits 0-5, PLLN bits 6-14, PLLP bits 16-17 (0 = /2 ... 3 = /8),
+    PLLSRC bit22, PLLQ bits 24-27, PLLR bits 28-30 kept at its reset value of 2 */
+    RCC->PLLCFGR = config->pllm |
+                   (config->plln << 6) |
+                   (((config->pllp / 2U) - 1U) << 16) |
+                   ((uint32_t)config->source << 22) |
+                   (config->pllq << 24) |
+                   (2UL << 28);
+
+    /* set bit24 to turn on the pll and wait for bit25 to indicate lock */
+    RCC->CR |= BIT(24);
+    while ((RCC->CR & BIT(25)) == 0) {}
+
+    if (next.hclk > RCC_OVERDRIVE_FREQ)
+    {
+        PWR_Overdrive_Enable();
+    }
+
+    /* raise the flash latency before the clock goes up */
+    uint32_t latency = RCC_Calc_Flash_Latency(next.hclk);
+    if (latency > FLASH_Get_Latency())
+    {
+        FLASH_Set_Latency(latency);
+    }
+
+    /* set the bus prescalers before switching so the apb buses are never
+    overclocked: HPRE bits 4-7, PPRE1 bits 10-12, PPRE2 bits 13-15 */
+    RCC->CFGR = (RCC->CFGR & ~((0xFUL << 4) | (0x7UL << 10) | (0x7UL << 13))) |
+                (encode_ahb_div(config->ahb_div) << 4) |
+                (encode_apb_div(config->apb1_div) << 10) |
+                (encode_apb_div(config->apb2_div) << 13);
+
+    /* select the pll as system clock (SW bits 0-1 = 0b10) and wait for
+    the switch status (SWS bits 2-3) to confirm it */
+    RCC->CFGR = (RCC->CFGR & ~3UL) | 2U;
+    while (((RCC->CFGR >> 2) & 3U) != 2U) {}
+
+    /* the latency can only be lowered once the clock is already lower */
+    if (latency < FLASH_Get_Latency())
+    {
+        FLASH_Set_Latency(latency);
+    }
+
+    clocks = next;
+    return RCC_OK;
+}
+
+/* system clock frequency in hz */
+uint32_t RCC_Get_SYSCLK_Freq(void)
+{
+    return clocks.sysclk;
+}
+
+/* ahb bus (core, systick, dma, gpio) frequency in hz */
+uint32_t RCC_Get_HCLK_Freq(void)
+{
+    return clocks.hclk;
+}
+
+/* apb1 bus (usart2-5, tim2-7) frequency in hz */
+uint32_t RCC_Get_PCLK1_Freq(void)
+{
+    return clocks.pclk1;
+}
+
+/* apb1 timer (tim2-7, tim12-14) clock frequency in hz */
+/* the timers run at twice the apb1 frequency unless apb1 is not divided */
+uint32_t RCC_Get_APB1_Timer_Freq(void)
+{
+    return (clocks.pclk1 == clocks.hclk) ? clocks.pclk1 : clocks.pclk1 * 2U;
+}
+
+/* apb2 bus (usart1/6, syscfg) frequency in hz */
+uint32_t RCC_Get_PCLK2_Freq(void)
+{
+    return clocks.pclk2;
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+#include "drivers/include/scb.h"
+
+/* set the vector table used for exceptions and interrupts */
+/* the table must be aligned to its size rounded up to a power of two,
+which is 512 bytes for the 113 entries of the STM32F446RE */
+void SCB_Set_Vector_Table(const void *table)
+{
+    SCB->VTOR = (uint32_t)(uintptr_t)table;
+
+    /* make sure the new table is used by the next exception */
+    sync_barrier();
+}
+
+/* give full access to the fpu */
+/* the firmware is built with -mfloat-abi=hard, so this must run before the
+first floating point instruction. lazy stacking (FPCCR ASPEN and LSPEN)
+is on after reset: exception entry only reserves room for the fp
+registers and saves them when the handler itself uses the fpu */
+void SCB_FPU_Enable(void)
+{
+    SCB_CPACR |= (15UL << 20);
+
+    sync_barrier();
+}
+
+/* make the pendsv exception pending by setting bit28 (PENDSVSET) in ICSR */
+/* writing 0 to the other bits has no effect */
+RAMFUNC void SCB_Trigger_PendSV(void)
+{
+    SCB->ICSR = BIT(28);
+}
\ No newline at end of file
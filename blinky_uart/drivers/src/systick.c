@@ -1,19 +1,44 @@
 #include "drivers/include/systick.h"
+#include "drivers/include/scb.h"
 
-volatile uint64_t ticks = 0; // systick tick counter
+/* systick tick counter */
+/* a 64-bit load is two loads on this core, so it must only be read
+through read_ticks */
+static volatile uint64_t ticks = 0;
+
+static uint32_t tick_cycles = 0; // clock cycles per tick, 0 until SYSTICK_Init
 
 /* increment the systick counter */
-void SYSTICK_Inc_Ticks(void)
+RAMFUNC void SYSTICK_Inc_Ticks(void)
 {
     ticks++;
 }
 
+/* read the tick counter without tearing */
+/* the systick interrupt can increment it between the loads of the low and
+high word, so it is read until two reads agree */
+static inline uint64_t read_ticks(void)
+{
+    uint64_t first;
+    uint64_t second;
+
+    do
+    {
+        first = ticks;
+        second = ticks;
+    } while (first != second);
+
+    return first;
+}
+
 /* initialize the systick timer to the specified tickrate */
 void SYSTICK_Init(uint32_t freq, SYSTICK_Time_Interval interval)
 {
     uint32_t tickrate = freq / interval;
 
-    if ((tickrate - 1) > 0xffffff) return; // the systick timer is 24-bit
+    if ((tickrate - 1) > SYSTICK_MAX_RELOAD) return; // the systick timer is 24-bit
+
+    tick_cycles = tickrate;
 
     SYSTICK->SYST_RVR = tickrate - 1; // set the reload value
     SYSTICK->SYST_CVR = 0; // clear the current value
@@ -25,6 +50,137 @@ void SYSTICK_Init(uint32_t freq, SYSTICK_Time_Interval interval)
 unit of time depends on how systick was initialized */
 void SYSTICK_Delay(uint32_t delay_period)
 {
-    uint64_t until = ticks + delay_period;
-    while (ticks < until) {}
+    uint64_t until = read_ticks() + delay_period;
+    while (read_ticks() < until) {}
+}
+
+/* number of ticks since the systick timer was initialized */
+RAMFUNC uint64_t SYSTICK_Get_Ticks(void)
+{
+    return read_ticks();
+}
+
+/* clock cycles per tick */
+RAMFUNC uint32_t SYSTICK_Get_Tick_Cycles(void)
+{
+    return tick_cycles;
+}
+
+/* clock cycles since the current tick started */
+/* read at the start of the systick handler this is the interrupt entry latency */
+RAMFUNC uint32_t SYSTICK_Get_Tick_Elapsed(void)
+{
+    return tick_cycles - 1U - SYSTICK->SYST_CVR;
+}
+
+/* clock cycles since the systick timer was initialized */
+/* the tick count gives the whole ticks and the current value of the counter
+the cycles into the current tick, so the resolution is one clock cycle
+without a faster interrupt. the counter can wrap between the two reads:
+if the tick count changed the reads are retried, and if the wrap is not
+counted yet because interrupts are masked (systick pending, bit26 in
+ICSR) the current value is read again and the tick is added here */
+uint64_t SYSTICK_Now(void)
+{
+    uint64_t now;
+    uint32_t current;
+    uint32_t wrapped;
+
+    do
+    {
+        now = read_ticks();
+        current = SYSTICK->SYST_CVR;
+        wrapped = 0;
+
+        if (SCB->ICSR & BIT(26))
+        {
+            current = SYSTICK->SYST_CVR;
+            wrapped = 1;
+        }
+    } while (now != read_ticks());
+
+    return (now + wrapped) * tick_cycles + (tick_cycles - 1U - current);
+}
+
+/* sleep for up to idle_ticks ticks without taking a systick interrupt for
+every tick, must be called with interrupts disabled */
+/* the reload value is stretched so the counter only wraps at the end of the
+last tick, and the processor sleeps in wfi until then or until another
+interrupt wakes it up. afterwards the counter is set up to finish the tick
+it is in and the ticks that passed are added to the tick counter */
+/* the last tick of a full sleep is counted by the pending systick interrupt
+as usual, so the returned number of skipped ticks does not include it */
+uint32_t SYSTICK_Sleep(uint32_t idle_ticks)
+{
+    if (tick_cycles == 0) return 0;
+
+    /* the systick timer is 24-bit, which limits the sleep to 93 ticks at 180 MHz */
+    uint32_t max_ticks = (SYSTICK_MAX_RELOAD + 1UL) / tick_cycles;
+    if (idle_ticks > max_ticks)
+    {
+        idle_ticks = max_ticks;
+    }
+
+    /* nothing to gain, sleep until the next tick */
+    if (idle_ticks < 2)
+    {
+        wait_for_interrupt();
+        return 0;
+    }
+
+    /* clear bit0 to stop the counter, the cycles left in the current tick are kept in the current value */
+    SYSTICK->SYST_CSR &= ~BIT(0);
+    uint32_t remaining = SYSTICK->SYST_CVR;
+
+    /* the tick ended while stopping, leave it to the pending interrupt (bit26 in ICSR) */
+    if ((SCB->ICSR & BIT(26)) || remaining == 0)
+    {
+        SYSTICK->SYST_CSR |= BIT(0);
+        return 0;
+    }
+
+    /* wrap at the end of the last idle tick */
+    uint32_t reload = remaining + tick_cycles * (idle_ticks - 1U);
+    SYSTICK->SYST_RVR = reload - 1U;
+    SYSTICK->SYST_CVR = 0; // the counter loads the reload value on the next clock
+    SYSTICK->SYST_CSR |= BIT(0);
+
+    wait_for_interrupt();
+
+    SYSTICK->SYST_CSR &= ~BIT(0);
+
+    uint32_t skipped;
+    uint32_t next; // cycles until the next tick ends
+
+    if (SCB->ICSR & BIT(26))
+    {
+        /* slept until the end, the counter already runs in the next tick */
+        uint32_t late = reload - 1U - SYSTICK->SYST_CVR;
+        skipped = idle_ticks - 1U;
+        next = (late < tick_cycles) ? tick_cycles - late : 1U;
+    }
+    else
+    {
+        /* woken up early by another interrupt, count the ticks that fully passed */
+        uint32_t elapsed = (tick_cycles - remaining) + (reload - 1U - SYSTICK->SYST_CVR);
+        skipped = elapsed / tick_cycles;
+        next = tick_cycles - (elapsed % tick_cycles);
+    }
+
+    /* a reload value of 0 stops the counter */
+    if (next < 2)
+    {
+        next = 2;
+    }
+
+    /* run the rest of the current tick, the normal reload value is picked
+    up when it wraps */
+    SYSTICK->SYST_RVR = next - 1U;
+    SYSTICK->SYST_CVR = 0;
+    SYSTICK->SYST_CSR |= BIT(0);
+    SYSTICK->SYST_RVR = tick_cycles - 1U;
+
+    ticks += skipped;
+
+    return skipped;
 }
\ No newline at end of file
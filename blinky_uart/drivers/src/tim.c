@@ -0,0 +1,152 @@
+#include "drivers/include/tim.h"
+
+/* capture/compare mode register of a channel, channels 1 and 2 are in
+CCMR1 and channels 3 and 4 in CCMR2 */
+static inline volatile uint32_t *get_ccmr(TIM_Peripheral *timx, TIM_Channel channel)
+{
+    return (channel < TIM_CHANNEL_3) ? &timx->CCMR1 : &timx->CCMR2;
+}
+
+/* bit offset of a channel in its capture/compare mode register */
+static inline uint32_t ccmr_shift(TIM_Channel channel)
+{
+    return ((uint32_t)channel & 1U) * 8U;
+}
+
+/* set the prescaler and auto-reload value for a frequency */
+/* the prescaler is kept as small as possible so a period has as many
+steps as possible, but no more than TIM_MAX_PERIOD so the values fit the
+16-bit timers as well */
+/* freq must be between 1 and clock, so there is at least one cycle per period */
+static void set_frequency(TIM_Peripheral *timx, uint32_t clock, uint32_t freq)
+{
+    uint32_t cycles = clock / freq;
+    uint32_t prescaler = (cycles - 1U) / TIM_MAX_PERIOD;
+
+    timx->PSC = prescaler;
+    timx->ARR = cycles / (prescaler + 1U) - 1U;
+}
+
+/* set up a channel for pwm output at a frequency */
+/* clock is the timer clock (RCC_Get_APB1_Timer_Freq for tim2-5), the
+channel starts with a duty cycle of 0 in pwm mode 1, active high. channels
+of the same timer share the frequency, so initializing another channel
+changes it for all of them */
+void TIM_PWM_Init(TIM_Peripheral *timx, TIM_Channel channel, uint32_t clock, uint32_t freq)
+{
+    if (freq == 0 || freq > clock) return;
+
+    /* clear bit0 to stop the counter while it is configured */
+    timx->CR1 &= ~BIT(0);
+
+    set_frequency(timx, clock, freq);
+    timx->CCR[channel] = 0;
+
+    /* output compare mode is bits 4-6 and preload enable bit 3 of the
+    channel's byte, CCxS (bits 0-1) = 0 makes the channel an output. with
+    preload a new compare value only takes effect at the next update, so a
+    period is never cut short */
+    volatile uint32_t *ccmr = get_ccmr(timx, channel);
+    uint32_t shift = ccmr_shift(channel);
+    *ccmr = (*ccmr & ~(0xFFUL << shift)) | ((((uint32_t)TIM_OC_PWM1 << 4) | BIT(3)) << shift);
+
+    /* set CCxE to enable the channel output */
+    timx->CCER |= BIT((uint32_t)channel * 4U);
+
+    /* set bit7 to preload the auto-reload value as well */
+    timx->CR1 |= BIT(7);
+
+    /* set bit0 in EGR to generate an update that loads the preloaded values */
+    timx->EGR = BIT(0);
+
+    /* set bit0 to start the counter */
+    timx->CR1 |= BIT(0);
+}
+
+/* change the pwm frequency, keeping the duty cycle of every channel */
+/* the new values are preloaded and take effect at the next update event */
+void TIM_PWM_Set_Frequency(TIM_Peripheral *timx, uint32_t clock, uint32_t freq)
+{
+    if (freq == 0 || freq > clock) return;
+
+    uint32_t old_period = TIM_PWM_Get_Period(timx);
+
+    set_frequency(timx, clock, freq);
+
+    uint32_t new_period = TIM_PWM_Get_Period(timx);
+
+    /* the 32-bit timers reset with ARR = 0xFFFFFFFF, a period of 0 here
+    means the timer was never set up and there is no duty cycle to keep */
+    if (old_period == 0) return;
+
+    for (uint32_t channel = 0; channel < 4; channel++)
+    {
+        uint32_t compare = timx->CCR[channel];
+
+        if (compare > old_period) compare = old_period;
+
+        timx->CCR[channel] = (uint32_t)(((uint64_t)compare * new_period) / old_period);
+    }
+}
+
+/* set the duty cycle of a channel in 1/1000 of the period */
+void TIM_PWM_Set_Duty(TIM_Peripheral *timx, TIM_Channel channel, uint32_t permille)
+{
+    if (permille > 1000) permille = 1000;
+
+    timx->CCR[channel] = (TIM_PWM_Get_Period(timx) * permille) / 1000U;
+}
+
+/* number of counter steps in one pwm period, a compare value of this
+(or more) keeps the output active for the whole period */
+uint32_t TIM_PWM_Get_Period(TIM_Peripheral *timx)
+{
+    return timx->ARR + 1U;
+}
+
+/* set the output compare mode of a channel */
+/* switching between TIM_OC_PWM1 and TIM_OC_FORCE_INACTIVE turns a pwm
+output on and off without touching its frequency, duty cycle or dma */
+void TIM_Set_Output_Mode(TIM_Peripheral *timx, TIM_Channel channel, TIM_OC_Mode mode)
+{
+    volatile uint32_t *ccmr = get_ccmr(timx, channel);
+    uint32_t shift = ccmr_shift(channel) + 4U;
+
+    *ccmr = (*ccmr & ~(7UL << shift)) | ((uint32_t)mode << shift);
+}
+
+/* get the output compare mode of a channel */
+TIM_OC_Mode TIM_Get_Output_Mode(TIM_Peripheral *timx, TIM_Channel channel)
+{
+    return (TIM_OC_Mode)((*get_ccmr(timx, channel) >> (ccmr_shift(channel) + 4U)) & 7U);
+}
+
+/* load the compare value of a channel from a table by dma on every update
+event, so the duty cycle follows the table without the cpu */
+/* the dma stream must be the one the timer's update request is mapped to,
+e.g. tim2 update is DMA1 stream 1 (or 7) channel 3. the table is read in
+a circle, one entry per pwm period, and must stay valid until
+TIM_PWM_DMA_Stop */
+void TIM_PWM_DMA_Start(TIM_Peripheral *timx, TIM_Channel channel, DMA_Peripheral *dmax,
+                       DMA_Stream stream, DMA_Channel dma_channel, const uint32_t *table, uint16_t len)
+{
+    if (table == NULL || len == 0) return;
+
+    /* the compare registers are written a word at a time. the ccr of a
+    32-bit timer (tim2, tim5) takes a half-word write in both halves, which
+    would put the compare value far above the period */
+    DMA_Stream_Init(dmax, stream, dma_channel, DMA_MEM_TO_PERIPH,
+                    DMA_CONFIG_CIRCULAR | DMA_CONFIG_MEM_INC |
+                    DMA_CONFIG_PSIZE_32 | DMA_CONFIG_MSIZE_32);
+    DMA_Stream_Start(dmax, stream, &timx->CCR[channel], table, len);
+
+    /* set bit8 (UDE) to request a dma transfer on every update event */
+    timx->DIER |= BIT(8);
+}
+
+/* stop loading compare values by dma, the last value loaded stays */
+void TIM_PWM_DMA_Stop(TIM_Peripheral *timx, DMA_Peripheral *dmax, DMA_Stream stream)
+{
+    timx->DIER &= ~BIT(8);
+    DMA_Stream_Stop(dmax, stream);
+}
\ No newline at end of file
@@ -1,5 +1,199 @@
 #include "drivers/include/usart.h"
 
+#if (USART_TX_BUFFER_SIZE & (USART_TX_BUFFER_SIZE - 1U)) != 0
+#error "USART_TX_BUFFER_SIZE must be a power of two"
+#endif
+
+#if (USART_RX_BUFFER_SIZE & (USART_RX_BUFFER_SIZE - 1U)) != 0
+#error "USART_RX_BUFFER_SIZE must be a power of two"
+#endif
+
+#if (USART_RX_MAX_FRAMES & (USART_RX_MAX_FRAMES - 1U)) != 0
+#error "USART_RX_MAX_FRAMES must be a power of two"
+#endif
+
+/* transmit ring buffer */
+/* head and tail are free-running counters, the number of queued bytes
+is always head - tail and the buffer index is the counter masked
+by the buffer size */
+typedef struct
+{
+    char buf[USART_TX_BUFFER_SIZE];
+    volatile uint32_t head; // next free slot, only written by producers
+    volatile uint32_t tail; // next byte to send, only written by the txe interrupt
+} tx_ring;
+
+/* receive ring buffer */
+/* single producer (the rx interrupt) and single consumer (USART_Read_Frame),
+so no locking is needed: each counter is only written by one side and is
+published with release/acquire ordering after the data it guards */
+/* frame_end holds the byte count (head) at which each received frame ended,
+frames are delimited by the idle line interrupt */
+typedef struct
+{
+    char buf[USART_RX_BUFFER_SIZE];
+    uint32_t head;                           // next free slot, only written by the rx interrupt
+    uint32_t tail;                           // next unread byte, only written by the reader
+    uint32_t frame_end[USART_RX_MAX_FRAMES];
+    uint32_t frame_head;                     // only written by the rx interrupt
+    uint32_t frame_tail;                     // only written by the reader
+    uint32_t last_end;                       // end of the last queued frame, used by the rx interrupt
+    USART_Error_Counts errors;
+} rx_ring;
+
+/* state kept for every usart that uses the asynchronous api */
+typedef struct
+{
+    USART_Peripheral *usartx; // usart this state belongs to, NULL if the slot is free
+    tx_ring tx;
+    rx_ring rx;
+    USART_Frame_Notify frame_notify;   // called when a frame was queued, NULL if unused
+
+    /* dma mode */
+    DMA_Peripheral *dma;               // dma controller bound by USART_DMA_Init, NULL if unused
+    DMA_Stream dma_tx_stream;
+    DMA_Stream dma_rx_stream;
+    volatile uint8_t dma_tx_busy;      // set while a dma transmit is in progress
+    USART_Tx_Callback dma_tx_callback;
+    char *dma_rx_buf;                  // circular receive buffer
+    size_t dma_rx_len;
+    USART_Rx_Callback dma_rx_callback;
+} usart_state;
+
+static usart_state states[USART_MAX_INSTANCES];
+
+/* find the state bound to a usart, returns NULL if the usart
+was never initialized */
+RAMFUNC static usart_state *get_state(USART_Peripheral *usartx)
+{
+    for (uint32_t i = 0; i < USART_MAX_INSTANCES; i++)
+    {
+        if (states[i].usartx == usartx)
+        {
+            return &states[i];
+        }
+    }
+
+    return NULL;
+}
+
+/* bind a usart to a free state slot (or its existing one) and reset it */
+static void bind_state(USART_Peripheral *usartx)
+{
+    usart_state *state = get_state(usartx);
+
+    if (state == NULL)
+    {
+        state = get_state(NULL); // grab a free slot
+    }
+
+    if (state != NULL)
+    {
+        state->usartx = usartx;
+        state->tx.head = 0;
+        state->tx.tail = 0;
+        state->rx.head = 0;
+        state->rx.tail = 0;
+        state->rx.frame_head = 0;
+        state->rx.frame_tail = 0;
+        state->rx.last_end = 0;
+        state->rx.errors = (USART_Error_Counts){ 0 };
+        state->frame_notify = NULL;
+        state->dma = NULL;
+        state->dma_tx_busy = 0;
+        state->dma_tx_callback = NULL;
+        state->dma_rx_buf = NULL;
+        state->dma_rx_len = 0;
+        state->dma_rx_callback = NULL;
+    }
+}
+
+/* store a received byte, called from the rx interrupt */
+static inline void rx_push(rx_ring *rx, char byte)
+{
+    uint32_t head = rx->head;
+
+    if (head - __atomic_load_n(&rx->tail, __ATOMIC_ACQUIRE) >= USART_RX_BUFFER_SIZE)
+    {
+        rx->errors.dropped++;
+        return;
+    }
+
+    rx->buf[head & (USART_RX_BUFFER_SIZE - 1U)] = byte;
+    __atomic_store_n(&rx->head, head + 1U, __ATOMIC_RELEASE);
+}
+
+/* mark the end of a frame at the current write position, called from the rx interrupt */
+/* if the frame queue is full the bytes are kept and become part of the next frame */
+/* returns 1 if a frame was queued */
+static inline uint8_t rx_end_frame(rx_ring *rx)
+{
+    uint32_t head = rx->head;
+    uint32_t frame_head = rx->frame_head;
+
+    if (head == rx->last_end) return 0; // line went idle without new bytes
+
+    if (frame_head - __atomic_load_n(&rx->frame_tail, __ATOMIC_ACQUIRE) >= USART_RX_MAX_FRAMES) return 0;
+
+    rx->frame_end[frame_head & (USART_RX_MAX_FRAMES - 1U)] = head;
+    rx->last_end = head;
+    __atomic_store_n(&rx->frame_head, frame_head + 1U, __ATOMIC_RELEASE);
+
+    return 1;
+}
+
+/* dma transmit stream callback */
+static void dma_tx_event(uint32_t flags, void *arg)
+{
+    usart_state *state = arg;
+
+    if (flags & (DMA_FLAG_TC | DMA_FLAG_TE))
+    {
+        /* clear bit7 in control register 3 to stop dma transmit requests */
+        state->usartx->CR3 &= ~BIT(7);
+
+        /* bytes queued by USART_Transmit_Async while the dma was busy are
+        sent by the txe interrupt from now on */
+        uint32_t primask = critical_section_enter();
+
+        state->dma_tx_busy = 0;
+
+        if (state->tx.head != state->tx.tail)
+        {
+            state->usartx->CR1 |= BIT(7);
+        }
+
+        critical_section_exit(primask);
+
+        if (state->dma_tx_callback != NULL)
+        {
+            state->dma_tx_callback();
+        }
+    }
+}
+
+/* dma receive stream callback */
+/* in circular mode the half transfer flag means the first half of the
+buffer is full and the transfer complete flag means the second half is
+full, the stream keeps writing into the other half in the meantime */
+static void dma_rx_event(uint32_t flags, void *arg)
+{
+    usart_state *state = arg;
+    size_t half = state->dma_rx_len / 2;
+
+    if (state->dma_rx_callback == NULL) return;
+
+    if (flags & DMA_FLAG_HT)
+    {
+        state->dma_rx_callback(state->dma_rx_buf, half);
+    }
+
+    if (flags & DMA_FLAG_TC)
+    {
+        state->dma_rx_callback(state->dma_rx_buf + half, state->dma_rx_len - half);
+    }
+}
+
 /* write a single byte to a usart */
 static inline void write_byte(USART_Peripheral *usartx, char *byte)
 {
@@ -24,7 +218,7 @@ static inline void read_byte(USART_Peripheral *usartx, __attribute__((unused)) c
 }
 
 /* initialize a uart peripheral */
-void USART_Init(USART_Peripheral *usartx, uint32_t freq, uint16_t baudrate)
+void USART_Init(USART_Peripheral *usartx, uint32_t freq, uint32_t baudrate)
 {
     /* reset usart control registers in case it has they have
     any bits already set */
@@ -38,8 +232,14 @@ void USART_Init(USART_Peripheral *usartx, uint32_t freq, uint16_t baudrate)
     /* set bit5 to generate an interrupt if usart detects a byte in the receive data register */
     usartx->CR1 |= BIT(5);
 
+    /* set bit4 to generate an interrupt when the receive line goes idle,
+    this marks the end of a frame */
+    usartx->CR1 |= BIT(4);
+
     /* set baud rate */
     usartx->BRR = UART_BRR_SAMPLING16(freq, baudrate);
+
+    bind_state(usartx);
 }
 
 /* write a buffer to a usart */
@@ -53,6 +253,309 @@ void USART_Transmit(USART_Peripheral *usartx, char *buf, size_t len)
     }
 }
 
+/* copy as much of a buffer as fits into the transmit ring buffer and
+return immediately, the txe interrupt sends the bytes in the background */
+/* while a dma transmit is in progress the bytes wait in the ring buffer
+and are sent once it has finished */
+/* returns the number of bytes queued, which is less than len if the ring
+buffer is full or 0 if the usart was not initialized */
+size_t USART_Transmit_Async(USART_Peripheral *usartx, const char *buf, size_t len)
+{
+    usart_state *state = get_state(usartx);
+
+    if (state == NULL) return 0;
+
+    /* producers can be interrupts of different priorities, so reserving
+    space, copying and enabling the txe interrupt must not be interleaved */
+    uint32_t primask = critical_section_enter();
+
+    uint32_t head = state->tx.head;
+    uint32_t space = USART_TX_BUFFER_SIZE - (head - state->tx.tail);
+
+    if (len > space)
+    {
+        len = space;
+    }
+
+    for (size_t i = 0; i < len; i++)
+    {
+        state->tx.buf[(head + i) & (USART_TX_BUFFER_SIZE - 1U)] = buf[i];
+    }
+
+    state->tx.head = head + (uint32_t)len;
+
+    /* set bit7 to generate an interrupt when the transmit data register is
+    empty, unless a dma transmit owns the data register until it is done */
+    if (len > 0 && !state->dma_tx_busy)
+    {
+        usartx->CR1 |= BIT(7);
+    }
+
+    critical_section_exit(primask);
+
+    return len;
+}
+
+/* number of bytes USART_Transmit_Async can queue right now */
+/* the space only grows until the next transmit, as the txe interrupt
+sends queued bytes */
+size_t USART_Tx_Space(USART_Peripheral *usartx)
+{
+    usart_state *state = get_state(usartx);
+
+    if (state == NULL) return 0;
+
+    return USART_TX_BUFFER_SIZE - (state->tx.head - state->tx.tail);
+}
+
+/* store received bytes in the receive ring buffer and end a frame when
+the line goes idle, send the next queued byte each time the transmit data
+register empties, and disable the txe interrupt once the ring buffer is drained */
+RAMFUNC void USART_IRQ_Handler(USART_Peripheral *usartx)
+{
+    usart_state *state = get_state(usartx);
+
+    if (state == NULL) return;
+
+    /* the error flags (bits 1-3) and the idle flag (bit4) are cleared by
+    reading the status register followed by the data register */
+    uint32_t sr = usartx->SR;
+
+    if (sr & BIT(3)) state->rx.errors.overrun++;
+    if (sr & BIT(2)) state->rx.errors.noise++;
+    if (sr & BIT(1)) state->rx.errors.framing++;
+
+    if (sr & BIT(5))
+    {
+        /* bit5 is set when a received byte is ready to be read */
+        rx_push(&state->rx, (char)(usartx->DR & 255));
+    }
+    else if (sr & (BIT(1) | BIT(2) | BIT(3) | BIT(4)))
+    {
+        (void)usartx->DR;
+    }
+
+    if ((sr & BIT(4)) && (usartx->CR1 & BIT(4)))
+    {
+        if (rx_end_frame(&state->rx) && state->frame_notify != NULL)
+        {
+            state->frame_notify();
+        }
+    }
+
+    /* bit7 in the status register is set when the transmit data register is empty */
+    if ((usartx->CR1 & BIT(7)) && (usartx->SR & BIT(7)))
+    {
+        uint32_t tail = state->tx.tail;
+
+        if (tail != state->tx.head)
+        {
+            usartx->DR = (uint8_t)state->tx.buf[tail & (USART_TX_BUFFER_SIZE - 1U)];
+            state->tx.tail = tail + 1U;
+        }
+        else
+        {
+            /* a higher priority producer may queue data between the check above
+            and clearing the enable bit, so recheck with interrupts disabled */
+            uint32_t primask = critical_section_enter();
+
+            if (state->tx.tail == state->tx.head)
+            {
+                usartx->CR1 &= ~BIT(7);
+            }
+
+            critical_section_exit(primask);
+        }
+    }
+}
+
+/* copy the oldest complete frame out of the receive ring buffer */
+/* if the frame is longer than len, the first len bytes are copied and the
+rest of the frame is discarded */
+/* returns the number of bytes copied, 0 if no complete frame is available */
+size_t USART_Read_Frame(USART_Peripheral *usartx, char *buf, size_t len)
+{
+    usart_state *state = get_state(usartx);
+
+    if (state == NULL) return 0;
+
+    rx_ring *rx = &state->rx;
+    uint32_t frame_tail = rx->frame_tail;
+
+    if (frame_tail == __atomic_load_n(&rx->frame_head, __ATOMIC_ACQUIRE)) return 0;
+
+    uint32_t tail = rx->tail;
+    uint32_t end = rx->frame_end[frame_tail & (USART_RX_MAX_FRAMES - 1U)];
+    size_t frame_len = end - tail;
+
+    if (frame_len > len)
+    {
+        frame_len = len;
+    }
+
+    for (size_t i = 0; i < frame_len; i++)
+    {
+        buf[i] = rx->buf[(tail + i) & (USART_RX_BUFFER_SIZE - 1U)];
+    }
+
+    /* release the whole frame, including any bytes that did not fit */
+    __atomic_store_n(&rx->tail, end, __ATOMIC_RELEASE);
+    __atomic_store_n(&rx->frame_tail, frame_tail + 1U, __ATOMIC_RELEASE);
+
+    return frame_len;
+}
+
+/* check if a complete frame is waiting to be read */
+uint8_t USART_Frame_Available(USART_Peripheral *usartx)
+{
+    usart_state *state = get_state(usartx);
+
+    if (state == NULL) return 0;
+
+    return state->rx.frame_tail != __atomic_load_n(&state->rx.frame_head, __ATOMIC_ACQUIRE);
+}
+
+/* register a function called from the usart interrupt whenever a complete
+frame was received, NULL removes it */
+/* meant to wake up the code that reads frames instead of polling */
+void USART_Set_Frame_Notify(USART_Peripheral *usartx, USART_Frame_Notify notify)
+{
+    usart_state *state = get_state(usartx);
+
+    if (state == NULL) return;
+
+    state->frame_notify = notify;
+}
+
+/* copy the receive error counters of a usart */
+void USART_Get_Errors(USART_Peripheral *usartx, USART_Error_Counts *errors)
+{
+    usart_state *state = get_state(usartx);
+
+    if (state == NULL) return;
+
+    uint32_t primask = critical_section_enter();
+    *errors = state->rx.errors;
+    critical_section_exit(primask);
+}
+
+/* bind a tx and rx dma stream to a usart */
+/* the usart must already be initialized with USART_Init, and the clock
+for the dma controller must be enabled */
+void USART_DMA_Init(USART_Peripheral *usartx, DMA_Peripheral *dmax, DMA_Stream tx_stream,
+                    DMA_Stream rx_stream, DMA_Channel channel)
+{
+    usart_state *state = get_state(usartx);
+
+    if (state == NULL) return;
+
+    state->dma = dmax;
+    state->dma_tx_stream = tx_stream;
+    state->dma_rx_stream = rx_stream;
+
+    DMA_Stream_Init(dmax, tx_stream, channel, DMA_MEM_TO_PERIPH,
+                    DMA_CONFIG_MEM_INC | DMA_CONFIG_TC_IRQ | DMA_CONFIG_TE_IRQ | DMA_CONFIG_PRIO_MEDIUM);
+    DMA_Stream_Init(dmax, rx_stream, channel, DMA_PERIPH_TO_MEM,
+                    DMA_CONFIG_MEM_INC | DMA_CONFIG_CIRCULAR | DMA_CONFIG_HT_IRQ |
+                    DMA_CONFIG_TC_IRQ | DMA_CONFIG_TE_IRQ | DMA_CONFIG_PRIO_HIGH);
+
+    DMA_Set_Callback(dmax, tx_stream, dma_tx_event, state);
+    DMA_Set_Callback(dmax, rx_stream, dma_rx_event, state);
+}
+
+/* send a buffer with dma without copying it */
+/* the buffer must not be modified until the callback runs. the dma and
+the ring buffer share the data register, so a dma transmit is only
+started while the ring buffer is empty, and bytes queued with
+USART_Transmit_Async in the meantime wait until the dma is done */
+/* returns the number of bytes being sent, which is 0 if a dma transmit is
+already in progress or the ring buffer is still sending, and at most 65535
+(the dma transfer count is 16-bit) */
+size_t USART_DMA_Transmit(USART_Peripheral *usartx, const char *buf, size_t len, USART_Tx_Callback callback)
+{
+    usart_state *state = get_state(usartx);
+
+    if (state == NULL || state->dma == NULL || len == 0) return 0;
+
+    if (len > 0xFFFFU)
+    {
+        len = 0xFFFFU;
+    }
+
+    /* any interrupt may start a transmit, so checking and claiming the
+    stream must not be interleaved */
+    uint32_t primask = critical_section_enter();
+
+    if (state->dma_tx_busy || state->tx.head != state->tx.tail)
+    {
+        critical_section_exit(primask);
+        return 0;
+    }
+
+    state->dma_tx_busy = 1;
+
+    critical_section_exit(primask);
+
+    state->dma_tx_callback = callback;
+
+    DMA_Stream_Start(state->dma, state->dma_tx_stream, &usartx->DR, buf, (uint16_t)len);
+
+    /* set bit7 in control register 3 to request a dma transfer each time
+    the transmit data register is empty */
+    usartx->CR3 |= BIT(7);
+
+    return len;
+}
+
+/* check if USART_DMA_Transmit can start a transmit right now */
+uint8_t USART_DMA_Tx_Ready(USART_Peripheral *usartx)
+{
+    usart_state *state = get_state(usartx);
+
+    if (state == NULL || state->dma == NULL) return 0;
+
+    return !state->dma_tx_busy && state->tx.head == state->tx.tail;
+}
+
+/* start receiving into a circular buffer with dma */
+/* the callback is run with each half of the buffer once it is full, so
+len should be even and large enough that one half can be processed while
+the other half is being filled */
+void USART_DMA_Receive(USART_Peripheral *usartx, char *buf, size_t len, USART_Rx_Callback callback)
+{
+    usart_state *state = get_state(usartx);
+
+    if (state == NULL || state->dma == NULL || len < 2 || len > 0xFFFFU) return;
+
+    state->dma_rx_buf = buf;
+    state->dma_rx_len = len;
+    state->dma_rx_callback = callback;
+
+    /* clear bit5 and bit4 so the rxne and idle interrupts do not steal
+    bytes from the dma */
+    usartx->CR1 &= ~(BIT(5) | BIT(4));
+
+    DMA_Stream_Start(state->dma, state->dma_rx_stream, &usartx->DR, buf, (uint16_t)len);
+
+    /* set bit6 in control register 3 to request a dma transfer each time
+    a byte is received */
+    usartx->CR3 |= BIT(6);
+}
+
+/* stop a circular dma receive and return to interrupt-driven receive */
+void USART_DMA_Receive_Stop(USART_Peripheral *usartx)
+{
+    usart_state *state = get_state(usartx);
+
+    if (state == NULL || state->dma == NULL) return;
+
+    usartx->CR3 &= ~BIT(6);
+    DMA_Stream_Stop(state->dma, state->dma_rx_stream);
+    state->dma_rx_callback = NULL;
+
+    usartx->CR1 |= BIT(5) | BIT(4);
+}
+
 void USART_Receive_Byte(USART_Peripheral *usartx, __attribute__((unused)) char *buf)
 {
     read_byte(usartx, buf);
@@ -0,0 +1,68 @@
+#ifndef DEBOUNCE_H_
+#define DEBOUNCE_H_
+
+#include "drivers/include/exti.h"
+#include "drivers/include/gpio.h"
+#include "services/include/timer.h"
+
+/* timing of the debouncer in ticks, can be overridden with EXTRA_CFLAGS */
+/* an input has to read the same for DEBOUNCE_STABLE_TICKS samples in a row
+before a change is accepted */
+#ifndef DEBOUNCE_STABLE_TICKS
+#define DEBOUNCE_STABLE_TICKS 5U
+#endif
+#ifndef DEBOUNCE_LONG_PRESS_TICKS
+#define DEBOUNCE_LONG_PRESS_TICKS 1000U
+#endif
+#ifndef DEBOUNCE_DOUBLE_CLICK_TICKS
+#define DEBOUNCE_DOUBLE_CLICK_TICKS 300U
+#endif
+
+/* number of events that can wait in the event queue, must be a power of 2 */
+#define DEBOUNCE_EVENT_QUEUE_SIZE 16U
+
+/* debounced input events */
+typedef enum
+{
+    DEBOUNCE_PRESS,        // input became active
+    DEBOUNCE_RELEASE,      // input became inactive
+    DEBOUNCE_LONG_PRESS,   // input held active for DEBOUNCE_LONG_PRESS_TICKS
+    DEBOUNCE_DOUBLE_CLICK  // second press within DEBOUNCE_DOUBLE_CLICK_TICKS of a release
+} Debounce_Event_Type;
+
+/* event taken from the event queue */
+typedef struct
+{
+    uint8_t input; // id given to DEBOUNCE_Add
+    uint8_t type;  // Debounce_Event_Type
+} Debounce_Event;
+
+/* called after an event was queued, from the systick interrupt */
+typedef void (*Debounce_Notify)(void);
+
+/* debounced input, owned by the caller (usually a static variable) */
+/* the fields are managed by the debouncer and must not be modified directly */
+typedef struct Debounce_Input
+{
+    struct Debounce_Input *next; // next input being sampled
+    GPIO_Peripheral *gpiox;
+    uint16_t pin;                // GPIO_Pin, also the exti line
+    uint8_t id;
+    uint8_t active_low;          // 1 if the input reads low while active
+    uint8_t sampling;            // 1 while the exti line is masked and the input is sampled
+    uint8_t state;               // debounced state, 1 while active
+    uint8_t count;               // samples in a row that differ from state
+    uint8_t clicked;             // double click detection state
+    uint32_t time;               // ticks since the last change of state
+} Debounce_Input;
+
+/* add an input on a gpio pin, the pin must be configured as input */
+void DEBOUNCE_Add(Debounce_Input *, GPIO_Port, GPIO_Pin, uint8_t, uint8_t);
+/* take the oldest event from the event queue, returns 0 if it is empty */
+uint8_t DEBOUNCE_Get_Event(Debounce_Event *);
+/* returns 1 if events are waiting in the event queue */
+uint8_t DEBOUNCE_Event_Pending(void);
+/* register a function called whenever an event is queued */
+void DEBOUNCE_Set_Notify(Debounce_Notify);
+
+#endif // DEBOUNCE_H_
\ No newline at end of file
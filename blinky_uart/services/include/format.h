@@ -0,0 +1,14 @@
+#ifndef FORMAT_H_
+#define FORMAT_H_
+
+#include "drivers/include/common.h"
+
+/* longest decimal representation of a 32-bit value */
+#define FORMAT_U32_MAX_LEN 10U
+
+/* write a value as decimal digits, returns the number of characters written (no terminator) */
+size_t FORMAT_U32(char *, uint32_t);
+/* copy a string without its terminator, returns the number of characters written */
+size_t FORMAT_String(char *, const char *);
+
+#endif // FORMAT_H_
\ No newline at end of file
@@ -0,0 +1,68 @@
+#ifndef KERNEL_H_
+#define KERNEL_H_
+
+#include "drivers/include/common.h"
+#include "services/include/timer.h"
+
+/* preemptive kernel, 1 to run the application in kernel threads, 0 to run
+it directly from main(). can be enabled with make EXTRA_CFLAGS=-DKERNEL=1 */
+#ifndef KERNEL
+#define KERNEL 0
+#endif
+
+/* number of thread priorities, 0 is the lowest and belongs to the idle thread */
+#define KERNEL_PRIORITIES 32U
+
+/* ticks a thread runs before the next ready thread of the same priority gets the cpu */
+#ifndef KERNEL_TIME_SLICE
+#define KERNEL_TIME_SLICE 10U
+#endif
+
+/* stack size of the idle thread in words */
+#define KERNEL_IDLE_STACK_WORDS 128U
+
+/* value the stacks are filled with, to find how much of them was used */
+#define KERNEL_STACK_FILL 0xDEADBEEFUL
+
+/* thread entry function, a thread that returns is stopped */
+typedef void (*Kernel_Entry)(void *);
+
+/* thread states */
+typedef enum
+{
+    KERNEL_THREAD_READY,    // running or waiting for the cpu
+    KERNEL_THREAD_SLEEPING, // waiting for its timer
+    KERNEL_THREAD_STOPPED   // returned from its entry function
+} Kernel_Thread_State;
+
+/* thread, owned by the caller (usually a static variable) together with its stack */
+/* the fields are managed by the kernel and must not be modified directly */
+typedef struct Kernel_Thread
+{
+    uint32_t *sp;               // saved stack pointer, must be the first field (used by PendSV_Handler)
+    struct Kernel_Thread *next; // next thread in the same ready list
+    uint32_t *stack;            // lowest address of the stack
+    uint32_t stack_words;
+    Timer timer;                // wakes the thread up from KERNEL_Sleep
+    uint8_t priority;
+    uint8_t state;              // Kernel_Thread_State
+} Kernel_Thread;
+
+/* set up a thread with a stack of a number of words, it runs once KERNEL_Start is called */
+void KERNEL_Thread_Create(Kernel_Thread *, Kernel_Entry, void *, uint32_t *, uint32_t, uint8_t);
+/* start running threads, does not return */
+void KERNEL_Start(void) __attribute__((noreturn));
+/* advance the time slice, must be called from the systick handler */
+RAMFUNC void KERNEL_Tick(void);
+/* give the cpu to the next ready thread of the same priority */
+void KERNEL_Yield(void);
+/* block the calling thread for a number of ticks */
+void KERNEL_Sleep(uint32_t);
+/* thread that is running */
+Kernel_Thread *KERNEL_Current(void);
+/* number of stack words a thread never used */
+uint32_t KERNEL_Stack_Unused(const Kernel_Thread *);
+/* cycles taken by the last and the slowest context switch */
+void KERNEL_Get_Switch_Cycles(uint32_t *, uint32_t *);
+
+#endif // KERNEL_H_
\ No newline at end of file
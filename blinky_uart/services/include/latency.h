@@ -0,0 +1,52 @@
+#ifndef LATENCY_H_
+#define LATENCY_H_
+
+#include "drivers/include/dwt.h"
+#include "drivers/include/exti.h"
+#include "drivers/include/systick.h"
+#include "drivers/include/usart.h"
+
+/* interrupt latency tracing, 1 to record latency and jitter histograms,
+0 to leave the handlers uninstrumented. can be disabled with
+make EXTRA_CFLAGS=-DLATENCY_TRACE=0 */
+#ifndef LATENCY_TRACE
+#define LATENCY_TRACE 1
+#endif
+
+/* number of histogram buckets */
+/* bucket 0 counts values of 0 cycles and bucket n values from 2^(n-1) up to
+2^n - 1 cycles, the last bucket also counts everything above */
+#define LATENCY_BUCKETS 16U
+
+/* recorded histograms */
+typedef enum
+{
+    LATENCY_SYSTICK_ENTRY,  // cycles from the systick counter wrap to the handler
+    LATENCY_SYSTICK_JITTER, // deviation of the time between two systick handlers from one tick
+    LATENCY_EXTI_ENTRY,     // cycles from a software triggered exti event to the handler
+    LATENCY_HISTOGRAM_COUNT
+} Latency_Histogram_Id;
+
+/* fixed-bucket histogram of values in clock cycles */
+typedef struct
+{
+    uint32_t buckets[LATENCY_BUCKETS];
+    uint32_t count;
+    uint32_t max;
+} Latency_Histogram;
+
+/* record the systick entry latency and period jitter, called in the
+systick handler right after SYSTICK_Inc_Ticks */
+RAMFUNC void LATENCY_SysTick_Entry(void);
+/* trigger an exti line from software and remember when */
+RAMFUNC void LATENCY_EXTI_Probe(EXTI_Line);
+/* record the exti entry latency, returns 1 if the interrupt was a probe */
+RAMFUNC uint8_t LATENCY_EXTI_Entry(void);
+/* copy a histogram */
+void LATENCY_Get_Histogram(Latency_Histogram_Id, Latency_Histogram *);
+/* clear all histograms */
+void LATENCY_Reset(void);
+/* print all histograms over a usart */
+void LATENCY_Dump(USART_Peripheral *);
+
+#endif // LATENCY_H_
\ No newline at end of file
@@ -0,0 +1,66 @@
+#ifndef LOG_H_
+#define LOG_H_
+
+#include "drivers/include/common.h"
+#include "drivers/include/usart.h"
+
+/* deferred binary logging */
+/* a log call site does not format anything. its format string is placed
+in the .logstr section, which is kept in firmware.elf but never loaded
+into the microcontroller, and only a record with the offset of the string
+and the raw 32-bit arguments is copied into a ram ring buffer. the ring
+is sent over the usart with dma in the background, and tools/logdecode.py
+formats the records on the host with the strings from firmware.elf */
+
+/* logging, 1 to write log records, 0 to compile every LOG out. can be
+disabled with make EXTRA_CFLAGS=-DLOGGING=0 */
+#ifndef LOGGING
+#define LOGGING 1
+#endif
+
+/* size of the log ring buffer in bytes, must be a power of two */
+#define LOG_BUFFER_SIZE 1024U
+
+/* most arguments of one log record */
+#define LOG_MAX_ARGS 4U
+
+/* first byte of every record, it is outside the ascii range so the
+decoder can tell records apart from text sent on the same usart */
+#define LOG_SYNC 0xA5U
+
+/* record layout, all values little endian:
+   LOG_SYNC, string offset in .logstr (16 bits), number of arguments,
+   then each argument as 32 bits */
+#define LOG_HEADER_SIZE 4U
+
+/* number of arguments passed to LOG, 0 to LOG_MAX_ARGS, LOG checks the limit */
+#define LOG_NARGS(...) LOG_NARGS_(0, ##__VA_ARGS__, 4, 3, 2, 1, 0)
+#define LOG_NARGS_(_0, _1, _2, _3, _4, n, ...) n
+
+/* log a printf-style format string with up to LOG_MAX_ARGS 32-bit integer
+arguments (%u, %d, %x and %c conversions), e.g. LOG("button %u", id) */
+/* can be used from interrupts, takes a few tens of cycles */
+#if LOGGING
+#define LOG(fmt, ...)                                                                       \
+    do                                                                                      \
+    {                                                                                       \
+        static const char log_string[] __attribute__((section(".logstr"), used)) = fmt;     \
+        const uint32_t log_args[] = { 0, ##__VA_ARGS__ };                                   \
+        _Static_assert(sizeof(log_args) / sizeof(log_args[0]) - 1U <= LOG_MAX_ARGS,         \
+                       "too many arguments for LOG");                                       \
+        LOG_Write(log_string, &log_args[1], LOG_NARGS(__VA_ARGS__));                        \
+    } while (0)
+#else
+#define LOG(fmt, ...) do {} while (0)
+#endif
+
+/* copy a record into the log ring buffer, called through LOG */
+void LOG_Write(const char *, const uint32_t *, uint32_t);
+/* returns 1 if records are waiting to be sent */
+uint8_t LOG_Pending(void);
+/* start sending the log ring buffer with a usart's dma, returns the number of bytes being sent */
+size_t LOG_Drain(USART_Peripheral *);
+/* number of records dropped because the log ring buffer was full */
+uint32_t LOG_Get_Dropped(void);
+
+#endif // LOG_H_
\ No newline at end of file
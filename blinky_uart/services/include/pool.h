@@ -0,0 +1,72 @@
+#ifndef POOL_H_
+#define POOL_H_
+
+#include "drivers/include/common.h"
+
+/* fixed-size block pools */
+/* a pool hands out blocks of one size from a caller-owned array. free
+blocks are kept in a singly linked list threaded through the blocks
+themselves, so allocating and freeing take the same few instructions no
+matter how many blocks are in use, and the pool needs no memory besides
+the blocks and the Pool struct */
+
+/* pool debug checks, 1 to detect double frees and frees of pointers that
+are not blocks of the pool, 0 to only check the pointer range. can be
+enabled with make EXTRA_CFLAGS=-DPOOL_DEBUG=1 */
+#ifndef POOL_DEBUG
+#define POOL_DEBUG 0
+#endif
+
+/* most blocks a pool can have when POOL_DEBUG is 1, each takes one bit. a
+larger pool is set up empty */
+#define POOL_DEBUG_MAX_BLOCKS 256U
+
+/* size of a block in words, blocks are at least one word (the free list
+link) and a multiple of 4 bytes */
+#define POOL_BLOCK_WORDS(block_size) (((block_size) + 3U) / 4U)
+
+/* number of words of storage for a pool, use to size the array passed to POOL_Init */
+/* e.g. static uint32_t storage[POOL_STORAGE_WORDS(sizeof(Message), 8)] SRAM2; */
+#define POOL_STORAGE_WORDS(block_size, blocks) (POOL_BLOCK_WORDS(block_size) * (blocks))
+
+/* usage of a pool */
+typedef struct
+{
+    uint32_t block_size; // bytes, rounded up to a multiple of 4
+    uint32_t blocks;
+    uint32_t used;       // blocks allocated right now
+    uint32_t high_water; // most blocks that were allocated at the same time
+    uint32_t failed;     // allocations that found the pool empty
+    uint32_t bad_frees;  // frees of pointers that are not allocated blocks of the pool
+} Pool_Stats;
+
+/* pool, owned by the caller (usually a static variable) */
+/* the storage can be placed anywhere, e.g. in SRAM2 with the SRAM2
+attribute. the fields are managed by the pool and must not be modified
+directly */
+typedef struct
+{
+    void *free;          // first free block, each free block holds a pointer to the next one
+    uint8_t *storage;
+    uint8_t *end;        // first byte after the storage
+    Pool_Stats stats;
+#if POOL_DEBUG
+    uint32_t allocated[POOL_DEBUG_MAX_BLOCKS / 32U]; // bit n is set while block n is allocated
+#endif
+} Pool;
+
+/* set up a pool of a number of blocks of a size in bytes in caller-owned storage */
+void POOL_Init(Pool *, uint32_t *, size_t, uint32_t);
+/* allocate a block, returns NULL if the pool is empty */
+void *POOL_Alloc(Pool *);
+/* return a block to the pool it was allocated from */
+void POOL_Free(Pool *, void *);
+/* allocate from the smallest of a number of pools (size classes) whose blocks fit a size */
+void *POOL_Alloc_Class(Pool *, uint32_t, size_t);
+/* return a block allocated with POOL_Alloc_Class, a pointer in none of the
+pools is counted in the bad frees of the first one */
+void POOL_Free_Class(Pool *, uint32_t, void *);
+/* get the usage of a pool */
+void POOL_Get_Stats(Pool *, Pool_Stats *);
+
+#endif // POOL_H_
\ No newline at end of file
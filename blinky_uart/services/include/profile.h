@@ -0,0 +1,66 @@
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include "drivers/include/dwt.h"
+#include "drivers/include/usart.h"
+
+/* cycle count profiling, 1 to measure the profiled sites, 0 to compile
+the macros to nothing. can be enabled with make EXTRA_CFLAGS=-DPROFILING=1 */
+#ifndef PROFILING
+#define PROFILING 0
+#endif
+
+/* cycle counter read by the profiling macros, a host build can define its
+own fake counter before including this header */
+#ifndef PROFILE_CYCLES
+#define PROFILE_CYCLES() (DWT->CYCCNT)
+#endif
+
+/* profiled sites, every site gets an entry in the statistics table and is
+printed under its name by PROFILE_Dump */
+#define PROFILE_SITES(SITE) \
+    SITE(SYSTICK_IRQ)       \
+    SITE(EXTI15_10_IRQ)     \
+    SITE(USART2_IRQ)        \
+    SITE(GPIO_PIN_INIT)
+
+#define PROFILE_SITE_ENUM(name) PROFILE_SITE_##name,
+
+/* profiled site ids */
+typedef enum
+{
+    PROFILE_SITES(PROFILE_SITE_ENUM)
+    PROFILE_SITE_COUNT
+} Profile_Site;
+
+/* statistics of one site, the mean is total / count */
+typedef struct
+{
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+} Profile_Stats;
+
+/* measure the cycles between PROFILE_BEGIN and PROFILE_END of a site,
+both must be in the same scope */
+/* the cycle counter wraps every 2^32 cycles, the unsigned difference is
+correct as long as a measurement is shorter than that */
+#if PROFILING
+#define PROFILE_BEGIN(site) uint32_t profile_start_##site = PROFILE_CYCLES()
+#define PROFILE_END(site) PROFILE_Record(PROFILE_SITE_##site, PROFILE_CYCLES() - profile_start_##site)
+#else
+#define PROFILE_BEGIN(site) do {} while (0)
+#define PROFILE_END(site) do {} while (0)
+#endif
+
+/* add a measurement to the statistics of a site */
+RAMFUNC void PROFILE_Record(Profile_Site, uint32_t);
+/* copy the statistics of a site */
+void PROFILE_Get_Stats(Profile_Site, Profile_Stats *);
+/* clear the statistics of all sites */
+void PROFILE_Reset(void);
+/* print the statistics of all sites over a usart */
+void PROFILE_Dump(USART_Peripheral *);
+
+#endif // PROFILE_H_
\ No newline at end of file
@@ -0,0 +1,167 @@
+#ifndef QUEUE_H_
+#define QUEUE_H_
+
+#include "drivers/include/common.h"
+
+/* fixed-capacity lock-free queues for passing items out of interrupts */
+/* each macro defines a queue type of a given item type and size (a power
+of 2) together with its functions, all static inline so the item copies
+are sized at compile time. the queue is owned by the caller, usually a
+static variable. none of the functions disable interrupts */
+/* the point is latency, not speed. for a 4-byte item the static estimate
+of llvm-mca for the cortex-m4 (not measured on the board) is about 12
+cycles for the spsc push, 19 for the mpsc push and 11 more for every retry
+of its claim, against 14 for the same ring pushed with interrupts disabled
+(mrs, cpsid, msr). the critical section is as fast, but it holds off every
+interrupt while it runs. tests/test_queue.c checks both queues with threads
+on the host */
+
+/* single producer, single consumer queue */
+/* the producer only writes head and the consumer only writes tail, the
+item is written before head is published (release) and read after head
+is seen (acquire), so plain ordered loads and stores are enough and both
+sides finish in a fixed number of steps. a zero-initialized queue is
+empty. usually the producer is one interrupt and the consumer is thread
+mode code */
+#define QUEUE_SPSC_DEFINE(name, type, size)                                          \
+typedef struct                                                                       \
+{                                                                                    \
+    type items[size];                                                                \
+    uint32_t head; /* next free slot, written by the producer */                     \
+    uint32_t tail; /* oldest item, written by the consumer */                        \
+} name;                                                                              \
+                                                                                     \
+/* add an item, returns 0 if the queue is full */                                    \
+static inline uint8_t name##_Push(name *queue, const type *item)                     \
+{                                                                                    \
+    uint32_t head = queue->head;                                                     \
+                                                                                     \
+    if (head - __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE) >= (size)) return 0;  \
+                                                                                     \
+    queue->items[head & ((size) - 1U)] = *item;                                      \
+    __atomic_store_n(&queue->head, head + 1U, __ATOMIC_RELEASE);                     \
+                                                                                     \
+    return 1;                                                                        \
+}                                                                                    \
+                                                                                     \
+/* take the oldest item, returns 0 if the queue is empty */                          \
+static inline uint8_t name##_Pop(name *queue, type *item)                            \
+{                                                                                    \
+    uint32_t tail = queue->tail;                                                     \
+                                                                                     \
+    if (tail == __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE)) return 0;           \
+                                                                                     \
+    *item = queue->items[tail & ((size) - 1U)];                                      \
+    __atomic_store_n(&queue->tail, tail + 1U, __ATOMIC_RELEASE);                     \
+                                                                                     \
+    return 1;                                                                        \
+}                                                                                    \
+                                                                                     \
+/* returns 1 if the queue is empty, called by the consumer */                        \
+static inline uint8_t name##_Empty(name *queue)                                      \
+{                                                                                    \
+    return queue->tail == __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);           \
+}
+
+/* multiple producer, single consumer queue */
+/* every slot carries a sequence number that says whose turn it is: pos
+when the slot is free for the producer of position pos, pos + 1 once that
+producer has written its item, and pos + size once the consumer has read
+it. producers claim a position by moving head forward with a compare and
+swap, which compiles to an ldrex/strex loop, so interrupts of different
+priorities can push at the same time without disabling interrupts. the
+strex fails and the loop retries when an interrupt pushed in between */
+/* a producer that was interrupted between claiming its slot and writing
+the sequence number hides the items pushed after it until it continues.
+when all producers are interrupts and the consumer runs in thread mode
+this can never be seen, the interrupted producer always finishes first */
+/* the queue must be set up with name##_Init before use */
+#define QUEUE_MPSC_DEFINE(name, type, size)                                          \
+typedef struct                                                                       \
+{                                                                                    \
+    struct                                                                           \
+    {                                                                                \
+        uint32_t seq;                                                                \
+        type item;                                                                   \
+    } slots[size];                                                                   \
+    uint32_t head; /* next position to claim, shared by the producers */             \
+    uint32_t tail; /* oldest position, written by the consumer */                    \
+} name;                                                                              \
+                                                                                     \
+/* set up an empty queue */                                                          \
+static inline void name##_Init(name *queue)                                          \
+{                                                                                    \
+    for (uint32_t i = 0; i < (size); i++)                                            \
+    {                                                                                \
+        queue->slots[i].seq = i;                                                     \
+    }                                                                                \
+                                                                                     \
+    queue->head = 0;                                                                 \
+    queue->tail = 0;                                                                 \
+}                                                                                    \
+                                                                                     \
+/* add an item, returns 0 if the queue is full */                                    \
+static inline uint8_t name##_Push(name *queue, const type *item)                     \
+{                                                                                    \
+    uint32_t pos = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);                  \
+    uint32_t slot;                                                                   \
+                                                                                     \
+    while (1)                                                                        \
+    {                                                                                \
+        slot = pos & ((size) - 1U);                                                  \
+        uint32_t seq = __atomic_load_n(&queue->slots[slot].seq, __ATOMIC_ACQUIRE);   \
+        int32_t diff = (int32_t)(seq - pos);                                         \
+                                                                                     \
+        if (diff == 0)                                                               \
+        {                                                                            \
+            /* on failure pos is updated to the current head */                      \
+            if (__atomic_compare_exchange_n(&queue->head, &pos, pos + 1U, 1,         \
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))     \
+            {                                                                        \
+                break;                                                               \
+            }                                                                        \
+        }                                                                            \
+        else if (diff < 0)                                                           \
+        {                                                                            \
+            return 0; /* the slot still holds an item from the last round */         \
+        }                                                                            \
+        else                                                                         \
+        {                                                                            \
+            pos = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);                   \
+        }                                                                            \
+    }                                                                                \
+                                                                                     \
+    queue->slots[slot].item = *item;                                                 \
+    __atomic_store_n(&queue->slots[slot].seq, pos + 1U, __ATOMIC_RELEASE);           \
+                                                                                     \
+    return 1;                                                                        \
+}                                                                                    \
+                                                                                     \
+/* take the oldest item, returns 0 if the queue is empty */                          \
+static inline uint8_t name##_Pop(name *queue, type *item)                            \
+{                                                                                    \
+    uint32_t tail = queue->tail;                                                     \
+    uint32_t slot = tail & ((size) - 1U);                                            \
+                                                                                     \
+    if (__atomic_load_n(&queue->slots[slot].seq, __ATOMIC_ACQUIRE) != tail + 1U)     \
+    {                                                                                \
+        return 0;                                                                    \
+    }                                                                                \
+                                                                                     \
+    *item = queue->slots[slot].item;                                                 \
+    __atomic_store_n(&queue->slots[slot].seq, tail + (size), __ATOMIC_RELEASE);      \
+    queue->tail = tail + 1U;                                                         \
+                                                                                     \
+    return 1;                                                                        \
+}                                                                                    \
+                                                                                     \
+/* returns 1 if the queue is empty, called by the consumer */                        \
+static inline uint8_t name##_Empty(name *queue)                                      \
+{                                                                                    \
+    uint32_t tail = queue->tail;                                                     \
+    uint32_t seq = __atomic_load_n(&queue->slots[tail & ((size) - 1U)].seq,          \
+                                   __ATOMIC_ACQUIRE);                                \
+    return seq != tail + 1U;                                                         \
+}
+
+#endif // QUEUE_H_
\ No newline at end of file
@@ -0,0 +1,34 @@
+#ifndef SCHED_H_
+#define SCHED_H_
+
+#include "drivers/include/common.h"
+
+/* run-to-completion event scheduler */
+/* events are posted to one of SCHED_PRIORITIES queues, usually from
+interrupts, and their handlers run one at a time in thread mode, highest
+priority queue first. a handler is never preempted by another handler,
+only by interrupts, so handlers need no locking between each other */
+#define SCHED_PRIORITIES 8U
+
+/* number of events that can wait in each priority queue, must be a power of 2 */
+#define SCHED_QUEUE_SIZE 8U
+
+/* event handler, runs in thread mode with the argument given to SCHED_Post */
+typedef void (*Sched_Handler)(uint32_t);
+
+/* called with interrupts disabled when no event is waiting, it may sleep
+until an interrupt (which then runs once the scheduler enables interrupts again) */
+typedef void (*Sched_Idle_Hook)(void);
+
+/* set up the event queues, must be called before the first event is posted */
+void SCHED_Init(void);
+/* queue an event, returns 0 if the queue of the priority is full */
+uint8_t SCHED_Post(uint8_t, Sched_Handler, uint32_t);
+/* set the function called when no event is waiting */
+void SCHED_Set_Idle_Hook(Sched_Idle_Hook);
+/* run the handler of the oldest event of the highest priority, returns 0 if no event was waiting */
+uint8_t SCHED_Dispatch(void);
+/* dispatch events forever, idling when none are waiting */
+void SCHED_Run(void) __attribute__((noreturn));
+
+#endif // SCHED_H_
\ No newline at end of file
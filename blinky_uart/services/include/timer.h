@@ -0,0 +1,66 @@
+#ifndef TIMER_H_
+#define TIMER_H_
+
+#include "drivers/include/common.h"
+
+/* software timers driven by the systick interrupt */
+/* timers are kept in a hierarchical timing wheel: 4 levels of 64 slots,
+level 0 holds timers expiring within 64 ticks, level 1 within 64^2 ticks
+and so on. starting, stopping and expiring a timer is O(1), and once every
+64 ticks the timers of one higher level slot are moved down a level */
+#define TIMER_WHEEL_BITS   6U
+#define TIMER_WHEEL_SLOTS  (1U << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_LEVELS 4U
+
+/* longest delay that is handled exactly (2^24 ticks, about 4.6 hours at 1 ms
+ticks), longer timers are parked in the last slot and rescheduled when they
+reach it */
+#define TIMER_MAX_DELAY ((1UL << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) - 1U)
+
+/* function called when a timer expires */
+typedef void (*Timer_Callback)(void *);
+
+/* timer options */
+typedef enum
+{
+    TIMER_RUN_IN_TICK = 0U,     // callback runs inside the systick interrupt
+    TIMER_DEFERRED    = BIT(0)  // callback runs from TIMER_Process in the main loop
+} Timer_Mode;
+
+/* software timer, owned by the caller (usually a static variable) */
+/* the fields are managed by the timer service and must not be modified directly */
+typedef struct Timer
+{
+    struct Timer *next;          // next timer in the same wheel slot
+    struct Timer **pprev;        // link pointing to this timer, NULL if not in the wheel
+    struct Timer *deferred_next; // next timer waiting for TIMER_Process
+    uint32_t expires;            // tick at which the timer expires
+    uint32_t period;             // reload period in ticks, 0 for a one-shot timer
+    Timer_Callback callback;
+    void *arg;
+    uint8_t mode;                // Timer_Mode
+    uint8_t deferred_pending;    // 1 while queued for TIMER_Process
+} Timer;
+
+/* set up a timer, must be called once before the timer is started */
+void TIMER_Init(Timer *, Timer_Callback, void *, Timer_Mode);
+/* start (or restart) a timer that expires after a delay in ticks and then every period ticks */
+RAMFUNC void TIMER_Start(Timer *, uint32_t, uint32_t);
+/* stop a timer, does nothing if it is not running */
+RAMFUNC void TIMER_Stop(Timer *);
+/* returns 1 if a timer is running */
+RAMFUNC uint8_t TIMER_Is_Active(const Timer *);
+/* advance the timer service by one tick, must be called from the systick handler */
+RAMFUNC void TIMER_Tick(void);
+/* advance the timer service by a number of ticks, used to catch up after a tickless sleep */
+void TIMER_Advance(uint32_t);
+/* number of ticks until the timer service has work to do, used to plan a tickless sleep */
+uint32_t TIMER_Ticks_Until_Next(void);
+/* returns 1 if deferred callbacks are waiting for TIMER_Process */
+uint8_t TIMER_Deferred_Pending(void);
+/* run the callbacks of expired deferred timers, called from the main loop */
+void TIMER_Process(void);
+/* number of ticks processed by the timer service */
+uint32_t TIMER_Now(void);
+
+#endif // TIMER_H_
\ No newline at end of file
@@ -0,0 +1,230 @@
+#include "services/include/debounce.h"
+#include "services/include/queue.h"
+
+/* double click detection state of an input */
+#define CLICK_NONE   0U // no click to pair with
+#define CLICK_ARMED  1U // released, a press in time is a double click
+#define CLICK_DOUBLE 2U // pressed as a double click, still held
+
+/* inputs being sampled, only these cost time on a tick */
+static Debounce_Input *sampling_head;
+
+/* sampling timer, only runs while an input is being sampled */
+static Timer sample_timer;
+static uint8_t sample_timer_ready;
+
+/* event queue */
+/* single producer (the sampling timer in the systick interrupt) and single
+consumer (DEBOUNCE_Get_Event) */
+QUEUE_SPSC_DEFINE(Debounce_Queue, Debounce_Event, DEBOUNCE_EVENT_QUEUE_SIZE)
+
+static Debounce_Queue events;
+
+static Debounce_Notify notify;
+
+/* queue an event, it is dropped if the queue is full */
+RAMFUNC static void queue_event(const Debounce_Input *input, Debounce_Event_Type type)
+{
+    Debounce_Event event = { input->id, (uint8_t)type };
+
+    if (!Debounce_Queue_Push(&events, &event)) return;
+
+    if (notify != NULL)
+    {
+        notify();
+    }
+}
+
+/* read the raw state of an input, 1 while active */
+static inline uint8_t read_input(const Debounce_Input *input)
+{
+    uint8_t level = (input->gpiox->IDR & input->pin) != 0;
+    return level ^ input->active_low;
+}
+
+/* sample one input, returns 1 while it has to be sampled further */
+RAMFUNC static uint8_t sample(Debounce_Input *input)
+{
+    if (input->time < UINT32_MAX)
+    {
+        input->time++;
+    }
+
+    if (read_input(input) != input->state)
+    {
+        /* a change is only accepted once it was stable long enough */
+        if (++input->count >= DEBOUNCE_STABLE_TICKS)
+        {
+            input->state ^= 1U;
+            input->count = 0;
+
+            if (input->state)
+            {
+                queue_event(input, DEBOUNCE_PRESS);
+
+                if (input->clicked == CLICK_ARMED && input->time <= DEBOUNCE_DOUBLE_CLICK_TICKS)
+                {
+                    queue_event(input, DEBOUNCE_DOUBLE_CLICK);
+                    input->clicked = CLICK_DOUBLE;
+                }
+            }
+            else
+            {
+                queue_event(input, DEBOUNCE_RELEASE);
+
+                /* the release of a double click or a long press does not
+                start a new double click */
+                if (input->clicked == CLICK_DOUBLE || input->time >= DEBOUNCE_LONG_PRESS_TICKS)
+                {
+                    input->clicked = CLICK_NONE;
+                }
+                else
+                {
+                    input->clicked = CLICK_ARMED;
+                }
+            }
+
+            input->time = 0;
+        }
+    }
+    else
+    {
+        input->count = 0;
+    }
+
+    if (input->state)
+    {
+        if (input->time == DEBOUNCE_LONG_PRESS_TICKS)
+        {
+            queue_event(input, DEBOUNCE_LONG_PRESS);
+        }
+
+        /* sampled for as long as it is held, so long presses are seen */
+        return 1;
+    }
+
+    if (input->clicked == CLICK_ARMED && input->time > DEBOUNCE_DOUBLE_CLICK_TICKS)
+    {
+        input->clicked = CLICK_NONE;
+    }
+
+    /* released and settled, wait for the next edge again */
+    return input->count != 0 || input->clicked == CLICK_ARMED;
+}
+
+/* sampling timer, runs every tick in the systick interrupt while any input
+is being sampled */
+RAMFUNC static void sample_inputs(void *arg)
+{
+    (void)arg;
+
+    Debounce_Input **link = &sampling_head;
+
+    while (*link != NULL)
+    {
+        Debounce_Input *input = *link;
+
+        if (sample(input))
+        {
+            link = &input->next;
+            continue;
+        }
+
+        /* stop sampling and let the next edge start it again. an edge
+        between the last sample and unmasking the line is not latched, so
+        the input is read once more after unmasking */
+        EXTI_Clear_Pending((EXTI_Line)input->pin);
+        EXTI_Unmask_Line((EXTI_Line)input->pin);
+
+        if (read_input(input) != input->state)
+        {
+            EXTI_Mask_Line((EXTI_Line)input->pin);
+            link = &input->next;
+            continue;
+        }
+
+        uint32_t primask = critical_section_enter();
+        *link = input->next;
+        input->next = NULL;
+        input->sampling = 0;
+        critical_section_exit(primask);
+    }
+
+    if (sampling_head == NULL)
+    {
+        TIMER_Stop(&sample_timer);
+    }
+}
+
+/* first edge of an input, runs in the exti interrupt */
+/* the line is masked so the bounces that follow cost no interrupts, and
+the input is sampled by the timer from now on */
+RAMFUNC static void input_edge(void *arg)
+{
+    Debounce_Input *input = arg;
+
+    EXTI_Mask_Line((EXTI_Line)input->pin);
+
+    uint32_t primask = critical_section_enter();
+
+    if (!input->sampling)
+    {
+        input->sampling = 1;
+        input->next = sampling_head;
+        sampling_head = input;
+    }
+
+    if (!TIMER_Is_Active(&sample_timer))
+    {
+        TIMER_Start(&sample_timer, 1, 1);
+    }
+
+    critical_section_exit(primask);
+}
+
+/* add an input on a gpio pin */
+/* the pin's exti line is set up to trigger on both edges and its
+interrupt must be enabled in the nvic. the id is passed back in events */
+void DEBOUNCE_Add(Debounce_Input *input, GPIO_Port port, GPIO_Pin pin, uint8_t active_low, uint8_t id)
+{
+    if (!sample_timer_ready)
+    {
+        TIMER_Init(&sample_timer, sample_inputs, NULL, TIMER_RUN_IN_TICK);
+        sample_timer_ready = 1;
+    }
+
+    input->next = NULL;
+    input->gpiox = GPIO_PORT_PERIPH(port);
+    input->pin = (uint16_t)pin;
+    input->id = id;
+    input->active_low = active_low ? 1U : 0U;
+    input->sampling = 0;
+    input->count = 0;
+    input->clicked = CLICK_NONE;
+    input->time = 0;
+    input->state = read_input(input);
+
+    /* exti line n is driven by pin n, so the pin bit is also the line bit */
+    EXTI_Line line = (EXTI_Line)pin;
+    EXTI_Set_Source(line, port);
+    EXTI_Register_Callback(line, input_edge, input);
+    EXTI_Line_Enable(line, EXTI_RISING_FALLING_EDGE_TRIGGER);
+}
+
+/* take the oldest event from the event queue */
+uint8_t DEBOUNCE_Get_Event(Debounce_Event *event)
+{
+    return Debounce_Queue_Pop(&events, event);
+}
+
+/* check if events are waiting in the event queue */
+uint8_t DEBOUNCE_Event_Pending(void)
+{
+    return !Debounce_Queue_Empty(&events);
+}
+
+/* register a function called whenever an event is queued, NULL removes it */
+void DEBOUNCE_Set_Notify(Debounce_Notify callback)
+{
+    notify = callback;
+}
\ No newline at end of file
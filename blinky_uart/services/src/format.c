@@ -0,0 +1,37 @@
+#include "services/include/format.h"
+
+/* write a value as decimal digits */
+/* the buffer must have room for FORMAT_U32_MAX_LEN characters */
+size_t FORMAT_U32(char *buf, uint32_t value)
+{
+    char digits[FORMAT_U32_MAX_LEN];
+    size_t len = 0;
+
+    /* digits come out least significant first */
+    do
+    {
+        digits[len++] = (char)('0' + (value % 10U));
+        value /= 10U;
+    } while (value != 0);
+
+    for (size_t i = 0; i < len; i++)
+    {
+        buf[i] = digits[len - 1U - i];
+    }
+
+    return len;
+}
+
+/* copy a string without its terminator */
+size_t FORMAT_String(char *buf, const char *str)
+{
+    size_t len = 0;
+
+    while (str[len] != '\0')
+    {
+        buf[len] = str[len];
+        len++;
+    }
+
+    return len;
+}
\ No newline at end of file
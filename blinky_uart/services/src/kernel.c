@@ -0,0 +1,372 @@
+#include "services/include/kernel.h"
+#include "drivers/include/nvic.h"
+#include "drivers/include/scb.h"
+
+#if KERNEL
+
+/* smallest stack a thread can have, room for a full context with fpu
+registers (26 words stacked by the hardware, 16 fp and 9 core registers
+saved by PendSV_Handler) plus a little for the thread itself */
+#define KERNEL_MIN_STACK_WORDS 64U
+
+/* exception return value that resumes a thread on the process stack
+without fpu context */
+#define EXC_RETURN_THREAD_PSP 0xFFFFFFFDUL
+
+/* the symbols below are used by PendSV_Handler, which is written in
+assembly, so they are marked used and keep their names */
+
+/* thread that runs, NULL until the first context switch */
+__attribute__((used)) static Kernel_Thread *kernel_current;
+
+/* context switch timing in dwt cycles, written by PendSV_Handler */
+__attribute__((used)) static uint32_t kernel_switch_start;
+__attribute__((used)) static volatile uint32_t kernel_switch_cycles;
+static uint32_t switch_cycles_max;
+
+/* ready lists, one circular list per priority that is kept by its last
+thread, so the thread at the head (tail->next) is the one that runs and
+adding a thread at the back is O(1) */
+static Kernel_Thread *ready_tail[KERNEL_PRIORITIES];
+
+/* bit n is set while priority n has ready threads */
+static uint32_t ready;
+
+/* ticks the running thread has had since it was switched to */
+static uint32_t slice_ticks;
+
+/* idle thread, runs when no other thread is ready */
+static Kernel_Thread idle_thread;
+static uint32_t idle_stack[KERNEL_IDLE_STACK_WORDS] __attribute__((aligned(8)));
+
+/* add a thread at the back of the ready list of its priority */
+RAMFUNC static void ready_add(Kernel_Thread *thread)
+{
+    Kernel_Thread *tail = ready_tail[thread->priority];
+
+    if (tail == NULL)
+    {
+        thread->next = thread;
+    }
+    else
+    {
+        thread->next = tail->next;
+        tail->next = thread;
+    }
+
+    ready_tail[thread->priority] = thread;
+    ready |= BIT(thread->priority);
+}
+
+/* remove a thread from the ready list of its priority */
+/* the list is walked to find the thread before it, ready lists only hold
+the threads of one priority so they are short */
+static void ready_remove(Kernel_Thread *thread)
+{
+    Kernel_Thread *tail = ready_tail[thread->priority];
+
+    if (tail == NULL) return;
+
+    if (thread->next == thread)
+    {
+        ready_tail[thread->priority] = NULL;
+        ready &= ~BIT(thread->priority);
+        return;
+    }
+
+    Kernel_Thread *prev = tail;
+    while (prev->next != thread)
+    {
+        prev = prev->next;
+        if (prev == tail) return; // not in the list
+    }
+
+    prev->next = thread->next;
+
+    if (tail == thread)
+    {
+        ready_tail[thread->priority] = prev;
+    }
+}
+
+/* move the running thread to the back of its ready list */
+/* returns 1 if another thread of the same priority is ready */
+static inline uint8_t rotate(void)
+{
+    Kernel_Thread *tail = ready_tail[kernel_current->priority];
+
+    if (kernel_current->state != KERNEL_THREAD_READY || tail == NULL || tail->next == tail) return 0;
+
+    ready_tail[kernel_current->priority] = tail->next;
+
+    return 1;
+}
+
+/* pick the thread to run next, called by PendSV_Handler */
+/* the highest ready priority is found with one count leading zeros
+instruction, the idle thread makes sure there always is one */
+__attribute__((used, noinline)) static Kernel_Thread *kernel_select(void)
+{
+    uint32_t primask = critical_section_enter();
+
+    /* the cycles of the switch before this one are complete by now */
+    if (kernel_switch_cycles > switch_cycles_max)
+    {
+        switch_cycles_max = kernel_switch_cycles;
+    }
+
+    uint32_t priority = 31U - (uint32_t)__builtin_clz(ready);
+    kernel_current = ready_tail[priority]->next;
+    slice_ticks = 0;
+
+    critical_section_exit(primask);
+
+    return kernel_current;
+}
+
+/* context switch */
+/* runs at the lowest exception priority, so it only runs once every other
+handler is done. the hardware has already pushed r0-r3, r12, lr, pc and
+xpsr on the thread's stack (and reserved room for s0-s15 and fpscr if the
+thread used the fpu). the rest of the context is pushed here: s16-s31 only
+when bit4 of EXC_RETURN is clear, which means the thread has fpu context,
+followed by r4-r11 and EXC_RETURN itself. the next thread's context is
+popped the same way. the dwt cycle counter is read at the start and end,
+the difference does not include exception entry and exit */
+__attribute__((naked)) void PendSV_Handler(void)
+{
+    __asm__ volatile (
+        "ldr r1, =0xE0001004\n\t"      // DWT->CYCCNT
+        "ldr r1, [r1]\n\t"
+        "ldr r2, =kernel_switch_start\n\t"
+        "str r1, [r2]\n\t"
+
+        "mrs r0, psp\n\t"
+        "ldr r2, =kernel_current\n\t"
+        "ldr r2, [r2]\n\t"
+        "cbz r2, 1f\n\t"               // first switch, nothing to save
+        "tst lr, #0x10\n\t"
+        "it eq\n\t"
+        "vstmdbeq r0!, {s16-s31}\n\t"
+        "stmdb r0!, {r4-r11, lr}\n\t"
+        "str r0, [r2]\n\t"             // kernel_current->sp
+
+        "1:\n\t"
+        "bl kernel_select\n\t"
+        "ldr r0, [r0]\n\t"             // next thread's sp
+        "ldmia r0!, {r4-r11, lr}\n\t"
+        "tst lr, #0x10\n\t"
+        "it eq\n\t"
+        "vldmiaeq r0!, {s16-s31}\n\t"
+        "msr psp, r0\n\t"
+
+        /* r0-r3 are restored from the stack on exception return, so they
+        are free for the measurement */
+        "ldr r1, =0xE0001004\n\t"
+        "ldr r1, [r1]\n\t"
+        "ldr r2, =kernel_switch_start\n\t"
+        "ldr r2, [r2]\n\t"
+        "sub r1, r1, r2\n\t"
+        "ldr r2, =kernel_switch_cycles\n\t"
+        "str r1, [r2]\n\t"
+        "bx lr\n\t"
+        ".ltorg\n\t"
+    );
+}
+
+/* a thread returned from its entry function */
+static void thread_exit(void)
+{
+    uint32_t primask = critical_section_enter();
+
+    kernel_current->state = KERNEL_THREAD_STOPPED;
+    ready_remove(kernel_current);
+    SCB_Trigger_PendSV();
+
+    critical_section_exit(primask);
+
+    while (1) {}
+}
+
+/* timer callback that ends KERNEL_Sleep, runs in the systick interrupt */
+RAMFUNC static void wake(void *arg)
+{
+    Kernel_Thread *thread = arg;
+
+    if (thread->state != KERNEL_THREAD_SLEEPING) return;
+
+    thread->state = KERNEL_THREAD_READY;
+    ready_add(thread);
+
+    if (kernel_current == NULL || thread->priority > kernel_current->priority)
+    {
+        SCB_Trigger_PendSV();
+    }
+}
+
+/* the idle thread sleeps until the next interrupt */
+static void idle(void *arg)
+{
+    (void)arg;
+
+    while (1)
+    {
+        wait_for_interrupt();
+    }
+}
+
+/* set up a thread with a stack of stack_words words */
+/* the stack is filled with KERNEL_STACK_FILL and a context is built on
+it as if the thread had been switched out right before its first
+instruction, with arg in r0. priority 0 is reserved for the idle thread */
+void KERNEL_Thread_Create(Kernel_Thread *thread, Kernel_Entry entry, void *arg,
+                          uint32_t *stack, uint32_t stack_words, uint8_t priority)
+{
+    if (priority >= KERNEL_PRIORITIES || stack_words < KERNEL_MIN_STACK_WORDS) return;
+
+    for (uint32_t i = 0; i < stack_words; i++)
+    {
+        stack[i] = KERNEL_STACK_FILL;
+    }
+
+    /* the stack pointer must be 8-byte aligned on exception return */
+    uint32_t *sp = (uint32_t *)((uintptr_t)&stack[stack_words] & ~(uintptr_t)7U);
+
+    /* frame popped by the hardware: r0-r3, r12, lr, pc, xpsr */
+    sp -= 8;
+    sp[0] = (uint32_t)(uintptr_t)arg;
+    sp[1] = 0;
+    sp[2] = 0;
+    sp[3] = 0;
+    sp[4] = 0;
+    sp[5] = (uint32_t)(uintptr_t)thread_exit;
+    sp[6] = (uint32_t)(uintptr_t)entry & ~1UL; // bit0 (thumb) goes into xpsr instead
+    sp[7] = BIT(24);                           // xpsr with the thumb bit set
+
+    /* registers popped by PendSV_Handler: r4-r11 and EXC_RETURN */
+    sp -= 9;
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        sp[i] = 0;
+    }
+    sp[8] = EXC_RETURN_THREAD_PSP;
+
+    thread->sp = sp;
+    thread->next = NULL;
+    thread->stack = stack;
+    thread->stack_words = stack_words;
+    thread->priority = priority;
+    thread->state = KERNEL_THREAD_READY;
+    TIMER_Init(&thread->timer, wake, thread, TIMER_RUN_IN_TICK);
+
+    uint32_t primask = critical_section_enter();
+    ready_add(thread);
+    critical_section_exit(primask);
+}
+
+/* start running threads */
+/* pendsv gets the lowest priority so a context switch never delays an
+interrupt. the first switch has no thread to save, the stack of main()
+is left behind and only used by handlers from now on */
+void KERNEL_Start(void)
+{
+    KERNEL_Thread_Create(&idle_thread, idle, NULL, idle_stack, KERNEL_IDLE_STACK_WORDS, 0);
+
+    NVIC_SetPriority(PendSV_IRQn, (1U << NVIC_PRIO_BITS) - 1U);
+
+    kernel_current = NULL;
+    SCB_Trigger_PendSV();
+
+    sync_barrier();
+
+    while (1) {}
+}
+
+/* advance the time slice */
+/* every KERNEL_TIME_SLICE ticks the running thread goes to the back of
+its ready list, so threads of the same priority share the cpu */
+RAMFUNC void KERNEL_Tick(void)
+{
+    if (kernel_current == NULL) return;
+
+    if (++slice_ticks < KERNEL_TIME_SLICE) return;
+
+    slice_ticks = 0;
+
+    if (rotate())
+    {
+        SCB_Trigger_PendSV();
+    }
+}
+
+/* give the cpu to the next ready thread of the same priority */
+void KERNEL_Yield(void)
+{
+    uint32_t primask = critical_section_enter();
+
+    if (rotate())
+    {
+        SCB_Trigger_PendSV();
+    }
+
+    critical_section_exit(primask);
+}
+
+/* block the calling thread for a number of ticks */
+/* the thread is woken up by a software timer, so sleeping threads cost
+nothing on a tick. the switch happens as soon as interrupts are enabled
+again at the end */
+void KERNEL_Sleep(uint32_t ticks)
+{
+    if (ticks == 0)
+    {
+        KERNEL_Yield();
+        return;
+    }
+
+    uint32_t primask = critical_section_enter();
+
+    Kernel_Thread *thread = kernel_current;
+    thread->state = KERNEL_THREAD_SLEEPING;
+    ready_remove(thread);
+
+    /* a delay of 0 expires on the next tick */
+    TIMER_Start(&thread->timer, ticks - 1U, 0);
+    SCB_Trigger_PendSV();
+
+    critical_section_exit(primask);
+}
+
+/* thread that is running */
+Kernel_Thread *KERNEL_Current(void)
+{
+    return kernel_current;
+}
+
+/* number of stack words a thread never used */
+/* counted from the bottom of the stack up to the first word that no
+longer holds KERNEL_STACK_FILL */
+uint32_t KERNEL_Stack_Unused(const Kernel_Thread *thread)
+{
+    uint32_t unused = 0;
+
+    while (unused < thread->stack_words && thread->stack[unused] == KERNEL_STACK_FILL)
+    {
+        unused++;
+    }
+
+    return unused;
+}
+
+/* cycles taken by the last and the slowest context switch */
+void KERNEL_Get_Switch_Cycles(uint32_t *last, uint32_t *max)
+{
+    uint32_t primask = critical_section_enter();
+
+    *last = kernel_switch_cycles;
+    *max = (kernel_switch_cycles > switch_cycles_max) ? kernel_switch_cycles : switch_cycles_max;
+
+    critical_section_exit(primask);
+}
+
+#endif // KERNEL
\ No newline at end of file
@@ -0,0 +1,170 @@
+#include "services/include/latency.h"
+#include "services/include/format.h"
+
+#if LATENCY_TRACE
+
+/* histogram names printed by LATENCY_Dump, in Latency_Histogram_Id order */
+static const char *const histogram_names[LATENCY_HISTOGRAM_COUNT] = {
+    "systick entry",
+    "systick jitter",
+    "exti entry"
+};
+
+/* every histogram is only written by one interrupt, readers copy it with
+interrupts disabled */
+static Latency_Histogram histograms[LATENCY_HISTOGRAM_COUNT];
+
+/* state of the systick period measurement */
+static uint32_t systick_last_cycles;
+static uint64_t systick_last_tick;
+static uint8_t systick_started;
+
+/* cycle count at which the pending exti probe was triggered */
+static volatile uint32_t probe_cycles;
+static volatile uint8_t probe_pending;
+
+/* add a value to a histogram */
+/* the bucket is the number of significant bits of the value, so one
+count leading zeros instruction finds it */
+static inline void record(Latency_Histogram *histogram, uint32_t cycles)
+{
+    uint32_t bucket = (cycles == 0) ? 0 : 32U - (uint32_t)__builtin_clz(cycles);
+
+    if (bucket >= LATENCY_BUCKETS)
+    {
+        bucket = LATENCY_BUCKETS - 1U;
+    }
+
+    histogram->buckets[bucket]++;
+    histogram->count++;
+
+    if (cycles > histogram->max)
+    {
+        histogram->max = cycles;
+    }
+}
+
+/* record the systick entry latency and period jitter */
+/* the latency is read from the systick counter, which counts the cycles
+since it wrapped, it includes the few cycles of SYSTICK_Inc_Ticks. the period is measured with the dwt cycle counter and
+only between handlers of consecutive ticks, so ticks skipped by a tickless
+sleep are not counted as jitter */
+RAMFUNC void LATENCY_SysTick_Entry(void)
+{
+    uint32_t elapsed = SYSTICK_Get_Tick_Elapsed();
+    uint32_t now = DWT->CYCCNT;
+    uint64_t tick = SYSTICK_Get_Ticks();
+
+    record(&histograms[LATENCY_SYSTICK_ENTRY], elapsed);
+
+    if (systick_started && tick == systick_last_tick + 1U)
+    {
+        uint32_t period = now - systick_last_cycles;
+        uint32_t tick_cycles = SYSTICK_Get_Tick_Cycles();
+        uint32_t jitter = (period > tick_cycles) ? period - tick_cycles : tick_cycles - period;
+
+        record(&histograms[LATENCY_SYSTICK_JITTER], jitter);
+    }
+
+    systick_last_cycles = now;
+    systick_last_tick = tick;
+    systick_started = 1;
+}
+
+/* trigger an exti line from software and remember when */
+/* the handler of the line must call LATENCY_EXTI_Entry first, the time
+until then includes every handler of a higher priority that runs first */
+RAMFUNC void LATENCY_EXTI_Probe(EXTI_Line line)
+{
+    uint32_t primask = critical_section_enter();
+
+    probe_cycles = DWT->CYCCNT;
+    probe_pending = 1;
+    EXTI_Software_Trigger(line);
+
+    critical_section_exit(primask);
+}
+
+/* record the exti entry latency, returns 1 if the interrupt was a probe */
+/* any line of the same interrupt that fires while a probe is pending is
+taken as the probe */
+RAMFUNC uint8_t LATENCY_EXTI_Entry(void)
+{
+    if (!probe_pending) return 0;
+
+    record(&histograms[LATENCY_EXTI_ENTRY], DWT->CYCCNT - probe_cycles);
+    probe_pending = 0;
+
+    return 1;
+}
+
+/* copy a histogram */
+void LATENCY_Get_Histogram(Latency_Histogram_Id id, Latency_Histogram *out)
+{
+    if (id >= LATENCY_HISTOGRAM_COUNT) return;
+
+    uint32_t primask = critical_section_enter();
+    *out = histograms[id];
+    critical_section_exit(primask);
+}
+
+/* clear all histograms */
+void LATENCY_Reset(void)
+{
+    uint32_t primask = critical_section_enter();
+
+    for (uint32_t i = 0; i < LATENCY_HISTOGRAM_COUNT; i++)
+    {
+        histograms[i] = (Latency_Histogram){ 0 };
+    }
+    systick_started = 0;
+
+    critical_section_exit(primask);
+}
+
+/* queue a whole line for transmission, waiting for room in the transmit ring buffer */
+static void dump_line(USART_Peripheral *usartx, const char *line, size_t len)
+{
+    size_t sent = 0;
+
+    while (sent < len)
+    {
+        sent += USART_Transmit_Async(usartx, &line[sent], len - sent);
+    }
+}
+
+/* print all histograms over a usart */
+/* every histogram starts with "<name> count=<n> max=<cycles>", followed by
+one "  <<limit>: <n>" line per non-empty bucket, where limit is the first
+value not counted in the bucket */
+void LATENCY_Dump(USART_Peripheral *usartx)
+{
+    for (uint32_t i = 0; i < LATENCY_HISTOGRAM_COUNT; i++)
+    {
+        Latency_Histogram histogram;
+        LATENCY_Get_Histogram((Latency_Histogram_Id)i, &histogram);
+
+        char line[48];
+        size_t len = FORMAT_String(line, histogram_names[i]);
+        len += FORMAT_String(&line[len], " count=");
+        len += FORMAT_U32(&line[len], histogram.count);
+        len += FORMAT_String(&line[len], " max=");
+        len += FORMAT_U32(&line[len], histogram.max);
+        len += FORMAT_String(&line[len], "\r\n");
+        dump_line(usartx, line, len);
+
+        for (uint32_t bucket = 0; bucket < LATENCY_BUCKETS; bucket++)
+        {
+            if (histogram.buckets[bucket] == 0) continue;
+
+            len = FORMAT_String(line, (bucket == LATENCY_BUCKETS - 1U) ? "  >=" : "  <");
+            len += FORMAT_U32(&line[len], (uint32_t)((bucket == LATENCY_BUCKETS - 1U) ? BIT(bucket - 1U) : BIT(bucket)));
+            len += FORMAT_String(&line[len], ": ");
+            len += FORMAT_U32(&line[len], histogram.buckets[bucket]);
+            len += FORMAT_String(&line[len], "\r\n");
+            dump_line(usartx, line, len);
+        }
+    }
+}
+
+#endif // LATENCY_TRACE
\ No newline at end of file
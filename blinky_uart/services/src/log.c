@@ -0,0 +1,146 @@
+#include "services/include/log.h"
+
+/* log ring buffer */
+/* records are written from interrupts of any priority, so reserving space
+and copying a record is done with interrupts disabled. a record is at
+most 20 bytes, so this only takes a few tens of cycles. the ring is
+drained by a single reader in thread mode, which sends it with dma
+straight out of the buffer */
+/* a record never wraps around the end of the buffer. when it would, the
+rest of the buffer is skipped and marked with LOG_PAD in place of the
+sync byte, so every dma transmit holds whole records */
+static struct
+{
+    uint8_t buf[LOG_BUFFER_SIZE];
+    uint32_t head;     // next free byte, only written by LOG_Write
+    uint32_t tail;     // next byte to send, only written when a dma transmit is done
+    uint32_t sending;  // bytes after tail owned by the dma, 0 while no transmit is in progress
+} ring;
+
+static uint32_t dropped;
+
+/* first byte of the unused end of the buffer, anything but LOG_SYNC */
+#define LOG_PAD 0x00U
+
+/* copy a record into the log ring buffer */
+/* the string is identified by its address, which is its offset in
+.logstr because the section is linked at address 0 (see link.ld). a
+record that does not fit is dropped whole, so the stream never holds a
+partial record */
+void LOG_Write(const char *string, const uint32_t *args, uint32_t nargs)
+{
+    if (nargs > LOG_MAX_ARGS)
+    {
+        nargs = LOG_MAX_ARGS;
+    }
+
+    uint32_t id = (uint32_t)(uintptr_t)string;
+    uint32_t len = LOG_HEADER_SIZE + nargs * 4U;
+
+    uint32_t primask = critical_section_enter();
+
+    uint32_t head = ring.head;
+    uint32_t offset = head & (LOG_BUFFER_SIZE - 1U);
+    uint32_t pad = (offset + len > LOG_BUFFER_SIZE) ? LOG_BUFFER_SIZE - offset : 0U;
+
+    if (LOG_BUFFER_SIZE - (head - __atomic_load_n(&ring.tail, __ATOMIC_ACQUIRE)) < pad + len)
+    {
+        dropped++;
+        critical_section_exit(primask);
+        return;
+    }
+
+    if (pad != 0)
+    {
+        ring.buf[offset] = LOG_PAD;
+        head += pad;
+    }
+
+    ring.buf[head++ & (LOG_BUFFER_SIZE - 1U)] = LOG_SYNC;
+    ring.buf[head++ & (LOG_BUFFER_SIZE - 1U)] = (uint8_t)id;
+    ring.buf[head++ & (LOG_BUFFER_SIZE - 1U)] = (uint8_t)(id >> 8);
+    ring.buf[head++ & (LOG_BUFFER_SIZE - 1U)] = (uint8_t)nargs;
+
+    for (uint32_t i = 0; i < nargs; i++)
+    {
+        uint32_t arg = args[i];
+
+        for (uint32_t byte = 0; byte < 4U; byte++)
+        {
+            ring.buf[head++ & (LOG_BUFFER_SIZE - 1U)] = (uint8_t)(arg >> (byte * 8U));
+        }
+    }
+
+    __atomic_store_n(&ring.head, head, __ATOMIC_RELEASE);
+
+    critical_section_exit(primask);
+}
+
+/* check if records are waiting to be sent */
+/* bytes that are being sent by the dma do not count */
+uint8_t LOG_Pending(void)
+{
+    uint32_t sending = __atomic_load_n(&ring.sending, __ATOMIC_ACQUIRE);
+
+    return sending == 0 && ring.tail != __atomic_load_n(&ring.head, __ATOMIC_ACQUIRE);
+}
+
+/* a dma transmit started by LOG_Drain is done, runs in the dma interrupt */
+/* the bytes are only released here, so LOG_Write cannot overwrite them
+while the dma still reads them */
+static void drain_done(void)
+{
+    __atomic_store_n(&ring.tail, ring.tail + ring.sending, __ATOMIC_RELEASE);
+    __atomic_store_n(&ring.sending, 0, __ATOMIC_RELEASE);
+}
+
+/* start sending the log ring buffer with dma */
+/* the records are sent straight from the ring buffer without being copied,
+one contiguous piece of whole records at a time (up to the padding at the
+end of the buffer). text sent with USART_Transmit_Async between two
+pieces can then only come between records, where the decoder expects it.
+nothing is started while a previous piece is still being sent or the
+usart cannot start a dma transmit, see USART_DMA_Tx_Ready */
+size_t LOG_Drain(USART_Peripheral *usartx)
+{
+    if (__atomic_load_n(&ring.sending, __ATOMIC_ACQUIRE) != 0) return 0;
+
+    uint32_t tail = ring.tail;
+    uint32_t head = __atomic_load_n(&ring.head, __ATOMIC_ACQUIRE);
+    uint32_t offset = tail & (LOG_BUFFER_SIZE - 1U);
+
+    /* skip the padding, the next record is at the start of the buffer */
+    if (tail != head && ring.buf[offset] != LOG_SYNC)
+    {
+        tail += LOG_BUFFER_SIZE - offset;
+        __atomic_store_n(&ring.tail, tail, __ATOMIC_RELEASE);
+        offset = 0;
+    }
+
+    if (tail == head) return 0;
+
+    uint32_t len = 0;
+
+    while (tail + len != head && offset + len < LOG_BUFFER_SIZE && ring.buf[offset + len] == LOG_SYNC)
+    {
+        len += LOG_HEADER_SIZE + ring.buf[offset + len + 3U] * 4U;
+    }
+
+    /* claimed before the transmit starts, drain_done may run right away */
+    ring.sending = len;
+
+    size_t sent = USART_DMA_Transmit(usartx, (const char *)&ring.buf[offset], len, drain_done);
+
+    if (sent == 0)
+    {
+        ring.sending = 0;
+    }
+
+    return sent;
+}
+
+/* number of records dropped because the log ring buffer was full */
+uint32_t LOG_Get_Dropped(void)
+{
+    return dropped;
+}
\ No newline at end of file
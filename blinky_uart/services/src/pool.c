@@ -0,0 +1,171 @@
+#include "services/include/pool.h"
+
+/* number of the block a pointer points into */
+static inline uint32_t block_number(const Pool *pool, const uint8_t *block)
+{
+    return (uint32_t)(block - pool->storage) / pool->stats.block_size;
+}
+
+/* set up a pool */
+/* the free list is built once here, in address order, so the storage may
+hold anything before, including uninitialized SRAM2. with POOL_DEBUG a
+pool of more than POOL_DEBUG_MAX_BLOCKS blocks is refused, it is set up
+empty (stats.blocks is 0) so it does not have a different capacity than
+in a release build */
+void POOL_Init(Pool *pool, uint32_t *storage, size_t block_size, uint32_t blocks)
+{
+    uint32_t size = (uint32_t)POOL_BLOCK_WORDS(block_size) * 4U;
+
+    if (size == 0)
+    {
+        size = 4U;
+    }
+
+#if POOL_DEBUG
+    if (blocks > POOL_DEBUG_MAX_BLOCKS)
+    {
+        blocks = 0;
+    }
+
+    for (uint32_t i = 0; i < POOL_DEBUG_MAX_BLOCKS / 32U; i++)
+    {
+        pool->allocated[i] = 0;
+    }
+#endif
+
+    pool->storage = (uint8_t *)storage;
+    pool->end = pool->storage + size * blocks;
+    pool->free = NULL;
+
+    /* link the blocks from the last to the first so the first is handed out first */
+    for (uint32_t i = blocks; i > 0; i--)
+    {
+        void **block = (void **)(void *)(pool->storage + size * (i - 1U));
+        *block = pool->free;
+        pool->free = block;
+    }
+
+    pool->stats = (Pool_Stats){ .block_size = size, .blocks = blocks };
+}
+
+/* allocate a block */
+/* blocks are allocated and freed from interrupts and thread mode, the
+free list is only touched with interrupts disabled, for a few cycles */
+void *POOL_Alloc(Pool *pool)
+{
+    uint32_t primask = critical_section_enter();
+
+    void **block = pool->free;
+
+    if (block == NULL)
+    {
+        pool->stats.failed++;
+        critical_section_exit(primask);
+        return NULL;
+    }
+
+    pool->free = *block;
+    pool->stats.used++;
+
+    if (pool->stats.used > pool->stats.high_water)
+    {
+        pool->stats.high_water = pool->stats.used;
+    }
+
+#if POOL_DEBUG
+    uint32_t n = block_number(pool, (uint8_t *)block);
+    pool->allocated[n / 32U] |= BIT(n % 32U);
+#endif
+
+    critical_section_exit(primask);
+
+    return block;
+}
+
+/* return a block to its pool */
+/* pointers outside the storage are always ignored and counted as bad
+frees. with POOL_DEBUG so are pointers into the middle of a block and
+blocks that are already free (double frees), which would otherwise
+corrupt the free list */
+void POOL_Free(Pool *pool, void *ptr)
+{
+    uint8_t *block = ptr;
+
+    if (block == NULL) return;
+
+    uint32_t primask = critical_section_enter();
+
+    if (block < pool->storage || block >= pool->end)
+    {
+        pool->stats.bad_frees++;
+        critical_section_exit(primask);
+        return;
+    }
+
+#if POOL_DEBUG
+    uint32_t n = block_number(pool, block);
+
+    if (block != pool->storage + n * pool->stats.block_size || !(pool->allocated[n / 32U] & BIT(n % 32U)))
+    {
+        pool->stats.bad_frees++;
+        critical_section_exit(primask);
+        return;
+    }
+
+    pool->allocated[n / 32U] &= ~BIT(n % 32U);
+#endif
+
+    *(void **)ptr = pool->free;
+    pool->free = ptr;
+    pool->stats.used--;
+
+    critical_section_exit(primask);
+}
+
+/* allocate from a set of size classes */
+/* the pools must be sorted by block size, smallest first. the block comes
+from the first pool whose blocks are large enough and that is not empty,
+so a full class spills over into the next larger one */
+void *POOL_Alloc_Class(Pool *pools, uint32_t count, size_t size)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (pools[i].stats.block_size < size) continue;
+
+        void *block = POOL_Alloc(&pools[i]);
+
+        if (block != NULL) return block;
+    }
+
+    return NULL;
+}
+
+/* return a block allocated with POOL_Alloc_Class */
+/* the pool is found from the address of the block. a pointer that is in
+none of the pools is ignored and counted as a bad free of the first pool */
+void POOL_Free_Class(Pool *pools, uint32_t count, void *ptr)
+{
+    uint8_t *block = ptr;
+
+    if (count == 0) return;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (block >= pools[i].storage && block < pools[i].end)
+        {
+            POOL_Free(&pools[i], ptr);
+            return;
+        }
+    }
+
+    /* outside the first pool too, so it only counts it */
+    POOL_Free(&pools[0], ptr);
+}
+
+/* get the usage of a pool */
+void POOL_Get_Stats(Pool *pool, Pool_Stats *stats)
+{
+    uint32_t primask = critical_section_enter();
+    *stats = pool->stats;
+    critical_section_exit(primask);
+}
\ No newline at end of file
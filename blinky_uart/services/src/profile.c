@@ -0,0 +1,103 @@
+#include "services/include/profile.h"
+#include "services/include/format.h"
+
+#if PROFILING
+
+#define PROFILE_SITE_NAME(name) #name,
+
+/* site names printed by PROFILE_Dump, in Profile_Site order */
+static const char *const site_names[PROFILE_SITE_COUNT] = {
+    PROFILE_SITES(PROFILE_SITE_NAME)
+};
+
+static Profile_Stats stats[PROFILE_SITE_COUNT];
+
+/* add a measurement to the statistics of a site */
+/* sites are also profiled in interrupts, so the update is done with
+interrupts disabled to keep the fields of a site consistent */
+RAMFUNC void PROFILE_Record(Profile_Site site, uint32_t cycles)
+{
+    if (site >= PROFILE_SITE_COUNT) return;
+
+    uint32_t primask = critical_section_enter();
+
+    Profile_Stats *entry = &stats[site];
+
+    if (entry->count == 0 || cycles < entry->min)
+    {
+        entry->min = cycles;
+    }
+    if (cycles > entry->max)
+    {
+        entry->max = cycles;
+    }
+    entry->total += cycles;
+    entry->count++;
+
+    critical_section_exit(primask);
+}
+
+/* copy the statistics of a site */
+void PROFILE_Get_Stats(Profile_Site site, Profile_Stats *out)
+{
+    if (site >= PROFILE_SITE_COUNT) return;
+
+    uint32_t primask = critical_section_enter();
+    *out = stats[site];
+    critical_section_exit(primask);
+}
+
+/* clear the statistics of all sites */
+void PROFILE_Reset(void)
+{
+    uint32_t primask = critical_section_enter();
+
+    for (uint32_t i = 0; i < PROFILE_SITE_COUNT; i++)
+    {
+        stats[i] = (Profile_Stats){ 0 };
+    }
+
+    critical_section_exit(primask);
+}
+
+/* queue a whole line for transmission, waiting for room in the transmit ring buffer */
+/* the blocking USART_Transmit would interleave with bytes queued by interrupts */
+static void dump_line(USART_Peripheral *usartx, const char *line, size_t len)
+{
+    size_t sent = 0;
+
+    while (sent < len)
+    {
+        sent += USART_Transmit_Async(usartx, &line[sent], len - sent);
+    }
+}
+
+/* print the statistics of all sites over a usart, one line per site:
+"<site> count=<n> min=<cycles> max=<cycles> mean=<cycles>" */
+/* sites that were never reached are skipped */
+void PROFILE_Dump(USART_Peripheral *usartx)
+{
+    for (uint32_t i = 0; i < PROFILE_SITE_COUNT; i++)
+    {
+        Profile_Stats entry;
+        PROFILE_Get_Stats((Profile_Site)i, &entry);
+
+        if (entry.count == 0) continue;
+
+        char line[96];
+        size_t len = FORMAT_String(line, site_names[i]);
+        len += FORMAT_String(&line[len], " count=");
+        len += FORMAT_U32(&line[len], entry.count);
+        len += FORMAT_String(&line[len], " min=");
+        len += FORMAT_U32(&line[len], entry.min);
+        len += FORMAT_String(&line[len], " max=");
+        len += FORMAT_U32(&line[len], entry.max);
+        len += FORMAT_String(&line[len], " mean=");
+        len += FORMAT_U32(&line[len], (uint32_t)(entry.total / entry.count));
+        len += FORMAT_String(&line[len], "\r\n");
+
+        dump_line(usartx, line, len);
+    }
+}
+
+#endif // PROFILING
\ No newline at end of file
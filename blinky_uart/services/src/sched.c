@@ -0,0 +1,105 @@
+#include "services/include/sched.h"
+#include "services/include/queue.h"
+
+/* posted event */
+typedef struct
+{
+    Sched_Handler handler;
+    uint32_t arg;
+} sched_event;
+
+/* event queue of one priority, posted to from interrupts of any priority */
+QUEUE_MPSC_DEFINE(Sched_Queue, sched_event, SCHED_QUEUE_SIZE)
+
+static Sched_Queue queues[SCHED_PRIORITIES];
+
+/* bit n is set while the queue of priority n may hold events */
+static uint32_t ready;
+
+static Sched_Idle_Hook idle_hook;
+
+/* queue an event */
+/* events are posted from interrupts of any priority. the queues are
+lock-free and the ready bitmap is updated with an atomic or, both are
+ldrex/strex loops, so posting never disables interrupts. the bit is set
+after the event is queued, so a set bit can be seen before its event but
+never the other way around. priority SCHED_PRIORITIES - 1 is the highest */
+uint8_t SCHED_Post(uint8_t priority, Sched_Handler handler, uint32_t arg)
+{
+    if (priority >= SCHED_PRIORITIES || handler == NULL) return 0;
+
+    sched_event event = { handler, arg };
+
+    if (!Sched_Queue_Push(&queues[priority], &event)) return 0;
+
+    __atomic_fetch_or(&ready, BIT(priority), __ATOMIC_RELEASE);
+
+    return 1;
+}
+
+/* set up the event queues, called once before the first event is posted */
+void SCHED_Init(void)
+{
+    for (uint32_t i = 0; i < SCHED_PRIORITIES; i++)
+    {
+        Sched_Queue_Init(&queues[i]);
+    }
+}
+
+/* set the function called when no event is waiting */
+void SCHED_Set_Idle_Hook(Sched_Idle_Hook hook)
+{
+    idle_hook = hook;
+}
+
+/* run the handler of the oldest event of the highest priority */
+/* the highest ready priority is found with one count leading zeros
+instruction, so the cost does not depend on the number of priorities. a
+bit is only cleared once its queue was found empty, and the queue is
+checked again afterwards, so an event posted in between keeps its bit */
+uint8_t SCHED_Dispatch(void)
+{
+    uint32_t pending;
+
+    while ((pending = __atomic_load_n(&ready, __ATOMIC_ACQUIRE)) != 0)
+    {
+        uint32_t priority = 31U - (uint32_t)__builtin_clz(pending);
+        sched_event event;
+
+        if (Sched_Queue_Pop(&queues[priority], &event))
+        {
+            event.handler(event.arg);
+            return 1;
+        }
+
+        __atomic_fetch_and(&ready, ~BIT(priority), __ATOMIC_ACQ_REL);
+
+        if (!Sched_Queue_Empty(&queues[priority]))
+        {
+            __atomic_fetch_or(&ready, BIT(priority), __ATOMIC_RELEASE);
+        }
+    }
+
+    return 0;
+}
+
+/* dispatch events forever */
+/* whether an event is waiting is checked again with interrupts disabled
+before idling, so an event posted after the last dispatch cannot be missed
+by a sleeping idle hook */
+void SCHED_Run(void)
+{
+    while (1)
+    {
+        while (SCHED_Dispatch()) {}
+
+        uint32_t primask = critical_section_enter();
+
+        if (__atomic_load_n(&ready, __ATOMIC_ACQUIRE) == 0 && idle_hook != NULL)
+        {
+            idle_hook();
+        }
+
+        critical_section_exit(primask);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,302 @@
+#include "services/include/timer.h"
+
+#define SLOT_MASK (TIMER_WHEEL_SLOTS - 1U)
+
+/* wheel slots, each slot is a singly linked list where every timer also
+points back at the link that points to it (pprev), so a timer can be
+unlinked in O(1) without knowing which slot it is in */
+static Timer *wheel[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+
+/* timers that expired during the current tick and still have to run */
+static Timer *expired;
+
+/* deferred timers waiting for TIMER_Process, in expiry order */
+static Timer *deferred_head;
+static Timer *deferred_tail;
+
+/* next tick to be processed, all timer positions are relative to it */
+static volatile uint32_t wheel_time;
+
+/* link a timer at the head of a list */
+static inline void list_add(Timer **head, Timer *timer)
+{
+    timer->next = *head;
+    timer->pprev = head;
+
+    if (*head != NULL)
+    {
+        (*head)->pprev = &timer->next;
+    }
+
+    *head = timer;
+}
+
+/* unlink a timer from whatever list it is in */
+static inline void list_del(Timer *timer)
+{
+    *timer->pprev = timer->next;
+
+    if (timer->next != NULL)
+    {
+        timer->next->pprev = timer->pprev;
+    }
+
+    timer->next = NULL;
+    timer->pprev = NULL;
+}
+
+/* put a timer in the wheel slot for its expiry time */
+/* the level is picked from the distance to wheel_time: level n covers
+distances below 64^(n+1), and within a level the slot is taken from the
+expiry time bits of that level */
+RAMFUNC static void wheel_add(Timer *timer)
+{
+    uint32_t expires = timer->expires;
+    uint32_t delta = expires - wheel_time;
+
+    if ((int32_t)delta < 0)
+    {
+        /* already due, expire on the next tick */
+        delta = 0;
+        expires = wheel_time;
+    }
+    else if (delta > TIMER_MAX_DELAY)
+    {
+        /* too far away, park it in the furthest slot and reschedule it from there */
+        delta = TIMER_MAX_DELAY;
+        expires = wheel_time + TIMER_MAX_DELAY;
+    }
+
+    uint32_t level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1U && delta >= (1UL << (TIMER_WHEEL_BITS * (level + 1U))))
+    {
+        level++;
+    }
+
+    uint32_t slot = (expires >> (TIMER_WHEEL_BITS * level)) & SLOT_MASK;
+    list_add(&wheel[level][slot], timer);
+}
+
+/* move every timer of a slot one or more levels down */
+/* returns the slot index, cascading continues to the next level while it is 0 */
+RAMFUNC static uint32_t cascade(uint32_t level)
+{
+    uint32_t slot = (wheel_time >> (TIMER_WHEEL_BITS * level)) & SLOT_MASK;
+    Timer *timer = wheel[level][slot];
+
+    wheel[level][slot] = NULL;
+
+    while (timer != NULL)
+    {
+        Timer *next = timer->next;
+        wheel_add(timer);
+        timer = next;
+    }
+
+    return slot;
+}
+
+/* queue a deferred timer for TIMER_Process */
+static inline void deferred_add(Timer *timer)
+{
+    if (timer->deferred_pending) return; // main loop is late, the expiry is merged
+
+    timer->deferred_pending = 1;
+    timer->deferred_next = NULL;
+
+    if (deferred_tail != NULL)
+    {
+        deferred_tail->deferred_next = timer;
+    }
+    else
+    {
+        deferred_head = timer;
+    }
+
+    deferred_tail = timer;
+}
+
+/* set up a timer */
+void TIMER_Init(Timer *timer, Timer_Callback callback, void *arg, Timer_Mode mode)
+{
+    timer->next = NULL;
+    timer->pprev = NULL;
+    timer->deferred_next = NULL;
+    timer->expires = 0;
+    timer->period = 0;
+    timer->callback = callback;
+    timer->arg = arg;
+    timer->mode = (uint8_t)mode;
+    timer->deferred_pending = 0;
+}
+
+/* start a timer, a running timer is restarted */
+/* a delay of 0 expires on the next tick, a period of 0 makes a one-shot timer */
+RAMFUNC void TIMER_Start(Timer *timer, uint32_t delay, uint32_t period)
+{
+    uint32_t primask = critical_section_enter();
+
+    if (timer->pprev != NULL)
+    {
+        list_del(timer);
+    }
+
+    timer->expires = wheel_time + delay;
+    timer->period = period;
+    wheel_add(timer);
+
+    critical_section_exit(primask);
+}
+
+/* stop a timer */
+/* a deferred timer that already expired but whose callback has not run yet
+still runs once from TIMER_Process */
+RAMFUNC void TIMER_Stop(Timer *timer)
+{
+    uint32_t primask = critical_section_enter();
+
+    if (timer->pprev != NULL)
+    {
+        list_del(timer);
+    }
+
+    critical_section_exit(primask);
+}
+
+/* check if a timer is running */
+RAMFUNC uint8_t TIMER_Is_Active(const Timer *timer)
+{
+    return timer->pprev != NULL;
+}
+
+/* process one tick */
+/* the cost per tick is the number of timers expiring in it, plus, once
+every 64 ticks, the number of timers moved down from a higher level */
+RAMFUNC void TIMER_Tick(void)
+{
+    uint32_t primask = critical_section_enter();
+
+    /* at the start of every round of level 0, refill it from level 1, and
+    so on up the levels */
+    if ((wheel_time & SLOT_MASK) == 0)
+    {
+        for (uint32_t level = 1; level < TIMER_WHEEL_LEVELS; level++)
+        {
+            if (cascade(level) != 0) break;
+        }
+    }
+
+    /* take the whole slot, it now only holds timers expiring this tick */
+    Timer **slot = &wheel[0][wheel_time & SLOT_MASK];
+    expired = *slot;
+    if (expired != NULL)
+    {
+        expired->pprev = &expired;
+    }
+    *slot = NULL;
+
+    wheel_time++;
+
+    /* run the expired timers one at a time, a callback may start or stop
+    other timers (including ones still on the expired list) */
+    while (expired != NULL)
+    {
+        Timer *timer = expired;
+        list_del(timer);
+
+        if (timer->period != 0)
+        {
+            /* reschedule from the previous expiry so periodic timers don't drift */
+            timer->expires += timer->period;
+            wheel_add(timer);
+        }
+
+        if (timer->mode & TIMER_DEFERRED)
+        {
+            deferred_add(timer);
+        }
+        else if (timer->callback != NULL)
+        {
+            critical_section_exit(primask);
+            timer->callback(timer->arg);
+            primask = critical_section_enter();
+        }
+    }
+
+    critical_section_exit(primask);
+}
+
+/* advance the timer service by a number of ticks at once */
+/* used after a tickless sleep to catch up with the ticks that had no
+systick interrupt */
+void TIMER_Advance(uint32_t count)
+{
+    while (count--)
+    {
+        TIMER_Tick();
+    }
+}
+
+/* number of ticks until the next tick that has work to do, 1 for the next tick */
+/* that is the first tick with expiring timers or the next refill of level 0
+from the higher levels, whichever comes first, so it is never more than 64.
+only level 0 has to be searched, a level 0 slot that is reached before the
+refill only holds timers expiring in that tick */
+uint32_t TIMER_Ticks_Until_Next(void)
+{
+    uint32_t primask = critical_section_enter();
+
+    uint32_t now = wheel_time;
+    uint32_t refill = (TIMER_WHEEL_SLOTS - (now & SLOT_MASK)) & SLOT_MASK;
+    uint32_t count = 0;
+
+    while (count < refill && wheel[0][(now + count) & SLOT_MASK] == NULL)
+    {
+        count++;
+    }
+
+    critical_section_exit(primask);
+
+    return count + 1U;
+}
+
+/* check if deferred timer callbacks are waiting for TIMER_Process */
+uint8_t TIMER_Deferred_Pending(void)
+{
+    return deferred_head != NULL;
+}
+
+/* run the callbacks of deferred timers that expired since the last call */
+void TIMER_Process(void)
+{
+    while (1)
+    {
+        uint32_t primask = critical_section_enter();
+
+        Timer *timer = deferred_head;
+        if (timer != NULL)
+        {
+            deferred_head = timer->deferred_next;
+            if (deferred_head == NULL)
+            {
+                deferred_tail = NULL;
+            }
+            timer->deferred_pending = 0;
+        }
+
+        critical_section_exit(primask);
+
+        if (timer == NULL) break;
+
+        if (timer->callback != NULL)
+        {
+            timer->callback(timer->arg);
+        }
+    }
+}
+
+/* current time of the timer service in ticks */
+uint32_t TIMER_Now(void)
+{
+    return wheel_time;
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#ifndef TEST_H_
+#define TEST_H_
+
+/* host unit tests */
+/* every tests/test_*.c is a program built by make test with the host
+compiler and HOST_TEST=1. it includes the sources it tests directly, so
+it can replace peripheral pointers with fake peripherals in memory and
+reach static helpers, and it simulates interrupts by calling the
+handlers. a test program exits with 1 if any check failed */
+
+#include <stdio.h>
+
+static unsigned int test_checks;
+static unsigned int test_failures;
+
+/* check a condition, a failure is reported and the test continues */
+#define CHECK(cond)                                                                  \
+    do                                                                               \
+    {                                                                                \
+        test_checks++;                                                               \
+        if (!(cond))                                                                 \
+        {                                                                            \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);          \
+            test_failures++;                                                         \
+        }                                                                            \
+    } while (0)
+
+/* check that two integers are equal, both values are reported on a failure */
+#define CHECK_EQ(actual, expected)                                                   \
+    do                                                                               \
+    {                                                                                \
+        unsigned long long check_actual = (unsigned long long)(actual);              \
+        unsigned long long check_expected = (unsigned long long)(expected);          \
+        test_checks++;                                                               \
+        if (check_actual != check_expected)                                          \
+        {                                                                            \
+            printf("%s:%d: %s is %llu (0x%llx), expected %llu (0x%llx)\n",           \
+                   __FILE__, __LINE__, #actual, check_actual, check_actual,          \
+                   check_expected, check_expected);                                  \
+            test_failures++;                                                         \
+        }                                                                            \
+    } while (0)
+
+/* print the result of a test program, returns its exit status */
+static inline int test_result(const char *name)
+{
+    printf("%s: %u checks, %u failed\n", name, test_checks, test_failures);
+    return test_failures == 0 ? 0 : 1;
+}
+
+#endif // TEST_H_
\ No newline at end of file
@@ -0,0 +1,168 @@
+#include "tests/test.h"
+
+#include "drivers/src/gpio.c"
+#include "core/include/board.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* fake gpio port */
+static GPIO_Peripheral gpio;
+
+static uint32_t random_word(void)
+{
+    return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+/* fill the configuration registers with random bits */
+static void scramble(void)
+{
+    gpio.MODER = random_word();
+    gpio.OTYPER = random_word() & 0xFFFFU;
+    gpio.OSPEEDR = random_word();
+    gpio.PUPDR = random_word();
+    gpio.AFRL = random_word();
+    gpio.AFRH = random_word();
+}
+
+/* only the field of the pin changes, and it holds the new value */
+static void check_field(uint32_t before, uint32_t after, uint32_t shift, uint32_t width, uint32_t value)
+{
+    uint32_t mask = ((1UL << width) - 1U) << shift;
+
+    CHECK_EQ(after & ~mask, before & ~mask);
+    CHECK_EQ((after & mask) >> shift, value);
+}
+
+/* every alternate function on every pin, pins 0-7 in AFRL and 8-15 in AFRH */
+static void test_af(void)
+{
+    for (uint32_t pinno = 0; pinno < 16; pinno++)
+    {
+        for (uint32_t af = 0; af < 16; af++)
+        {
+            scramble();
+            GPIO_Peripheral before = gpio;
+
+            GPIO_Set_AF(&gpio, (GPIO_Pin)BIT(pinno), (GPIO_AF)af);
+
+            if (pinno < 8)
+            {
+                check_field(before.AFRL, gpio.AFRL, pinno * 4U, 4, af);
+                CHECK_EQ(gpio.AFRH, before.AFRH);
+            }
+            else
+            {
+                check_field(before.AFRH, gpio.AFRH, (pinno - 8U) * 4U, 4, af);
+                CHECK_EQ(gpio.AFRL, before.AFRL);
+            }
+
+            CHECK_EQ(gpio.MODER, before.MODER);
+            CHECK_EQ(gpio.OSPEEDR, before.OSPEEDR);
+        }
+    }
+}
+
+/* the 2 bit and 1 bit fields of every pin, with every value */
+static void test_fields(void)
+{
+    for (uint32_t pinno = 0; pinno < 16; pinno++)
+    {
+        GPIO_Pin pin = (GPIO_Pin)BIT(pinno);
+
+        for (uint32_t value = 0; value < 4; value++)
+        {
+            scramble();
+            GPIO_Peripheral before = gpio;
+            GPIO_Set_Mode(&gpio, pin, (GPIO_Pin_Mode)value);
+            check_field(before.MODER, gpio.MODER, pinno * 2U, 2, value);
+
+            before = gpio;
+            GPIO_Set_Speed(&gpio, pin, (GPIO_Speed)value);
+            check_field(before.OSPEEDR, gpio.OSPEEDR, pinno * 2U, 2, value);
+
+            /* 3 is reserved for the pull, it is still only written to its own field */
+            before = gpio;
+            GPIO_Set_Pull(&gpio, pin, (GPIO_Pull)value);
+            check_field(before.PUPDR, gpio.PUPDR, pinno * 2U, 2, value);
+
+            before = gpio;
+            GPIO_Set_Output_Type(&gpio, pin, (GPIO_Output_Type)(value & 1U));
+            check_field(before.OTYPER, gpio.OTYPER, pinno, 1, value & 1U);
+
+            CHECK_EQ(gpio.AFRL, before.AFRL);
+            CHECK_EQ(gpio.AFRH, before.AFRH);
+        }
+    }
+}
+
+/* set and reset halves of BSRR */
+static void test_write(void)
+{
+    GPIO_Write(&gpio, PIN5, GPIO_PIN_SET);
+    CHECK_EQ(gpio.BSRR, BIT(5));
+    GPIO_Write(&gpio, PIN15, GPIO_PIN_RESET);
+    CHECK_EQ(gpio.BSRR, BIT(31));
+
+    GPIO_Write_Port(&gpio, 0x00F0U, 0x0F30U);
+    CHECK_EQ(gpio.BSRR, (0x00C0UL << 16) | 0x0030U);
+
+    gpio.ODR = 0x8421U;
+    GPIO_Toggle_Port(&gpio, 0xFF00U);
+    CHECK_EQ(gpio.BSRR, (0x8400UL << 16) | 0x7B00U);
+
+    gpio.IDR = 0x1234U;
+    CHECK_EQ(GPIO_Read_Port(&gpio, 0x00FFU), 0x0034U);
+    CHECK_EQ(GPIO_Read(&gpio, PIN2), GPIO_PIN_SET);
+    CHECK_EQ(GPIO_Read(&gpio, PIN0), GPIO_PIN_RESET);
+}
+
+/* applying the board's port configuration gives the same registers as
+setting every pin of the table one field at a time */
+#define SET_PIN(target, port, pinno, mode, af, speed, pull, otype)   \
+    if ((port) == (target))                                          \
+    {                                                                \
+        GPIO_Set_Output_Type(&gpio, BIT(pinno), otype);              \
+        GPIO_Set_Speed(&gpio, BIT(pinno), speed);                    \
+        GPIO_Set_Pull(&gpio, BIT(pinno), pull);                      \
+        GPIO_Set_AF(&gpio, BIT(pinno), af);                          \
+        GPIO_Set_Mode(&gpio, BIT(pinno), mode);                      \
+    }
+
+static void check_port_config(GPIO_Port port, const GPIO_Port_Config *config)
+{
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        scramble();
+        GPIO_Peripheral start = gpio;
+
+        BOARD_PIN_TABLE(SET_PIN, port)
+        GPIO_Peripheral expected = gpio;
+
+        gpio = start;
+        GPIO_Apply_Port_Config(&gpio, config);
+
+        CHECK(memcmp((const void *)&gpio, (const void *)&expected, sizeof(gpio)) == 0);
+    }
+}
+
+static void test_port_config(void)
+{
+    static const GPIO_Port_Config port_a = GPIO_PORT_CONFIG(BOARD_PIN_TABLE, GPIO_PORT_A);
+    static const GPIO_Port_Config port_c = GPIO_PORT_CONFIG(BOARD_PIN_TABLE, GPIO_PORT_C);
+
+    check_port_config(GPIO_PORT_A, &port_a);
+    check_port_config(GPIO_PORT_C, &port_c);
+}
+
+int main(void)
+{
+    srand(1);
+
+    test_af();
+    test_fields();
+    test_write();
+    test_port_config();
+
+    return test_result("gpio");
+}
\ No newline at end of file
@@ -0,0 +1,190 @@
+#include "tests/test.h"
+
+#include "services/src/log.c"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* LOG_Drain sends through USART_DMA_Transmit, this one keeps the piece
+and finishes the transmit when the test says so */
+static const uint8_t *piece;
+static size_t piece_len;
+static USART_Tx_Callback piece_done;
+static uint8_t usart_busy;
+
+size_t USART_DMA_Transmit(USART_Peripheral *usartx, const char *buf, size_t len, USART_Tx_Callback callback)
+{
+    (void)usartx;
+
+    if (usart_busy) return 0;
+
+    piece = (const uint8_t *)buf;
+    piece_len = len;
+    piece_done = callback;
+
+    return len;
+}
+
+/* what the usart sent, the pieces of the log and text in between */
+static uint8_t stream[1U << 20];
+static size_t stream_len;
+
+static void send_text(void)
+{
+    stream[stream_len++] = 'x';
+}
+
+/* send one piece and let text through after it, as the txe interrupt
+would for text queued while the dma was busy */
+static uint32_t split_pieces;
+
+static uint8_t drain_one(void)
+{
+    if (LOG_Drain(NULL) == 0) return 0;
+
+    /* a piece holds whole records */
+    size_t at = 0;
+    while (at < piece_len && piece[at] == LOG_SYNC)
+    {
+        at += LOG_HEADER_SIZE + piece[at + 3U] * 4U;
+    }
+    if (at != piece_len) split_pieces++;
+
+    memcpy(&stream[stream_len], piece, piece_len);
+    stream_len += piece_len;
+
+    piece_done();
+    send_text();
+
+    return 1;
+}
+
+/* ids of the records that made it into the ring, in order */
+#define RECORDS 20000U
+
+static uint32_t written_ids[RECORDS];
+static uint32_t written_count;
+
+static void write_record(void)
+{
+    uint32_t nargs = (uint32_t)rand() % (LOG_MAX_ARGS + 1U);
+    uint32_t args[LOG_MAX_ARGS];
+    uint32_t id = written_count & 0xFFFFU;
+
+    for (uint32_t i = 0; i < nargs; i++)
+    {
+        args[i] = id * 7U + i;
+    }
+
+    uint32_t before = LOG_Get_Dropped();
+    LOG_Write((const char *)(uintptr_t)id, args, nargs);
+
+    if (LOG_Get_Dropped() == before)
+    {
+        written_ids[written_count++] = id;
+    }
+}
+
+/* decode the stream like tools/logdecode.py, text between records is skipped */
+static void check_stream(void)
+{
+    size_t at = 0;
+    uint32_t next = 0;
+    uint32_t bad = 0;
+
+    while (at < stream_len)
+    {
+        if (stream[at] != LOG_SYNC)
+        {
+            if (stream[at] != 'x') bad++;
+            at++;
+            continue;
+        }
+
+        uint32_t id = stream[at + 1U] | ((uint32_t)stream[at + 2U] << 8);
+        uint32_t nargs = stream[at + 3U];
+
+        if (nargs > LOG_MAX_ARGS || next >= written_count || id != written_ids[next])
+        {
+            bad++;
+            break;
+        }
+
+        for (uint32_t i = 0; i < nargs; i++)
+        {
+            const uint8_t *arg = &stream[at + LOG_HEADER_SIZE + i * 4U];
+            uint32_t value = arg[0] | ((uint32_t)arg[1] << 8) | ((uint32_t)arg[2] << 16) | ((uint32_t)arg[3] << 24);
+
+            if (value != id * 7U + i) bad++;
+        }
+
+        at += LOG_HEADER_SIZE + nargs * 4U;
+        next++;
+    }
+
+    CHECK_EQ(bad, 0);
+    CHECK_EQ(next, written_count);
+}
+
+/* records of every size written and drained at random, the ring wraps
+hundreds of times and fills up now and then */
+static void test_whole_records(void)
+{
+    srand(1);
+
+    while (written_count < RECORDS - 10U)
+    {
+        uint32_t burst = (uint32_t)rand() % 80U;
+
+        for (uint32_t i = 0; i < burst && written_count < RECORDS - 10U; i++)
+        {
+            write_record();
+        }
+
+        /* sometimes the usart is still busy with text */
+        usart_busy = (rand() % 4) == 0;
+
+        uint32_t drains = (uint32_t)rand() % 4U;
+        for (uint32_t i = 0; i < drains; i++)
+        {
+            drain_one();
+        }
+    }
+
+    usart_busy = 0;
+    while (drain_one()) {}
+
+    CHECK(!LOG_Pending());
+    CHECK(LOG_Get_Dropped() > 0);
+    CHECK(stream_len > 100U * LOG_BUFFER_SIZE);
+    CHECK_EQ(split_pieces, 0);
+    check_stream();
+}
+
+/* nothing is sent while a piece is still on its way */
+static void test_one_piece_at_a_time(void)
+{
+    uint32_t args[1] = { 5 };
+
+    LOG_Write((const char *)(uintptr_t)1U, args, 1);
+    CHECK(LOG_Pending());
+    CHECK_EQ(LOG_Drain(NULL), LOG_HEADER_SIZE + 4U);
+
+    LOG_Write((const char *)(uintptr_t)2U, args, 1);
+    CHECK(!LOG_Pending());
+    CHECK_EQ(LOG_Drain(NULL), 0);
+
+    piece_done();
+    CHECK(LOG_Pending());
+    CHECK_EQ(LOG_Drain(NULL), LOG_HEADER_SIZE + 4U);
+    piece_done();
+    CHECK(!LOG_Pending());
+}
+
+int main(void)
+{
+    test_whole_records();
+    test_one_piece_at_a_time();
+
+    return test_result("log");
+}
\ No newline at end of file
@@ -0,0 +1,252 @@
+/* MAP_32BIT for the vector table below */
+#define _GNU_SOURCE
+
+#include "tests/test.h"
+
+#include "drivers/include/nvic.h"
+#include "drivers/include/scb.h"
+
+#include <stddef.h>
+#include <string.h>
+#include <sys/mman.h>
+
+/* fake nvic and system control block */
+static NVIC_Peripheral nvic;
+static SCB_Peripheral scb;
+
+#undef NVIC
+#define NVIC (&nvic)
+#undef SCB
+#define SCB (&scb)
+
+#include "drivers/src/nvic.c"
+
+/* the register layout matches the addresses in the reference manual */
+static void test_layout(void)
+{
+    CHECK_EQ(NVIC_PERIPH_BASE_ADDR + offsetof(NVIC_Peripheral, ICER), 0xE000E180U);
+    CHECK_EQ(NVIC_PERIPH_BASE_ADDR + offsetof(NVIC_Peripheral, ISPR), 0xE000E200U);
+    CHECK_EQ(NVIC_PERIPH_BASE_ADDR + offsetof(NVIC_Peripheral, ICPR), 0xE000E280U);
+    CHECK_EQ(NVIC_PERIPH_BASE_ADDR + offsetof(NVIC_Peripheral, IABR), 0xE000E300U);
+    CHECK_EQ(NVIC_PERIPH_BASE_ADDR + offsetof(NVIC_Peripheral, IPR), 0xE000E400U);
+    CHECK_EQ(SCB_BASE_ADDR + offsetof(SCB_Peripheral, ICSR), 0xE000ED04U);
+    CHECK_EQ(SCB_BASE_ADDR + offsetof(SCB_Peripheral, VTOR), 0xE000ED08U);
+    CHECK_EQ(SCB_BASE_ADDR + offsetof(SCB_Peripheral, AIRCR), 0xE000ED0CU);
+    CHECK_EQ(SCB_BASE_ADDR + offsetof(SCB_Peripheral, SHPR), 0xE000ED18U);
+}
+
+/* one bit per interrupt, 32 interrupts per register */
+static void test_enable(void)
+{
+    memset(&nvic, 0, sizeof(nvic));
+
+    NVIC_EnableIRQ(WWDG_IRQn);
+    NVIC_EnableIRQ(USART2_IRQn);
+    NVIC_EnableIRQ(FMPI2C1_ER_IRQn);
+    CHECK_EQ(nvic.ISER[0], BIT(0));
+    CHECK_EQ(nvic.ISER[1], BIT(USART2_IRQn - 32));
+    CHECK_EQ(nvic.ISER[3], BIT(FMPI2C1_ER_IRQn - 96));
+
+    /* set and clear registers are written with only the one bit set */
+    NVIC_DisableIRQ(USART2_IRQn);
+    CHECK_EQ(nvic.ICER[1], BIT(USART2_IRQn - 32));
+    CHECK_EQ(nvic.ICER[0], 0);
+
+    NVIC_SetPendingIRQ(EXTI15_10_IRQn);
+    CHECK_EQ(nvic.ISPR[1], BIT(EXTI15_10_IRQn - 32));
+    CHECK_EQ(NVIC_GetPendingIRQ(EXTI15_10_IRQn), 1);
+    CHECK_EQ(NVIC_GetPendingIRQ(USART2_IRQn), 0);
+    NVIC_ClearPendingIRQ(EXTI15_10_IRQn);
+    CHECK_EQ(nvic.ICPR[1], BIT(EXTI15_10_IRQn - 32));
+
+    nvic.IABR[0] = BIT(EXTI0_IRQn);
+    CHECK_EQ(NVIC_GetActive(EXTI0_IRQn), 1);
+    CHECK_EQ(NVIC_GetActive(EXTI1_IRQn), 0);
+
+    /* exceptions are not in the nvic */
+    memset(&nvic, 0, sizeof(nvic));
+    NVIC_EnableIRQ(SysTick_IRQn);
+    NVIC_SetPendingIRQ(PendSV_IRQn);
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        CHECK_EQ(nvic.ISER[i], 0);
+        CHECK_EQ(nvic.ISPR[i], 0);
+    }
+    CHECK_EQ(NVIC_GetPendingIRQ(SysTick_IRQn), 0);
+}
+
+/* priorities are stored in the upper 4 bits of a byte per interrupt */
+static void test_priority(void)
+{
+    memset(&nvic, 0, sizeof(nvic));
+    memset(&scb, 0, sizeof(scb));
+
+    for (int32_t irq = 0; irq <= FMPI2C1_ER_IRQn; irq++)
+    {
+        NVIC_SetPriority((IRQn_Type)irq, (uint32_t)irq & 15U);
+    }
+
+    for (int32_t irq = 0; irq <= FMPI2C1_ER_IRQn; irq++)
+    {
+        CHECK_EQ(nvic.IPR[irq], ((uint32_t)irq & 15U) << 4);
+        CHECK_EQ(NVIC_GetPriority((IRQn_Type)irq), (uint32_t)irq & 15U);
+    }
+
+    /* only 4 bits are kept */
+    NVIC_SetPriority(USART2_IRQn, 0x1FU);
+    CHECK_EQ(nvic.IPR[USART2_IRQn], 0xF0U);
+    CHECK_EQ(NVIC_GetPriority(USART2_IRQn), 15);
+    CHECK_EQ(nvic.IPR[USART2_IRQn + 1], ((USART2_IRQn + 1) & 15U) << 4);
+}
+
+/* system exceptions 4-15 are in SHPR, one byte each starting at exception 4 */
+static void test_exception_priority(void)
+{
+    static const struct
+    {
+        IRQn_Type irq;
+        uint32_t byte;
+    } exceptions[] = {
+        { MemoryManagement_IRQn, 0 },
+        { BusFault_IRQn,         1 },
+        { UsageFault_IRQn,       2 },
+        { SVCall_IRQn,           7 },
+        { DebugMonitor_IRQn,     8 },
+        { PendSV_IRQn,           10 },
+        { SysTick_IRQn,          11 }
+    };
+
+    memset(&nvic, 0, sizeof(nvic));
+    memset(&scb, 0, sizeof(scb));
+
+    for (uint32_t i = 0; i < sizeof(exceptions) / sizeof(exceptions[0]); i++)
+    {
+        uint8_t before[12];
+        memcpy(before, (const void *)scb.SHPR, sizeof(before));
+
+        uint32_t priority = 15U - i;
+        NVIC_SetPriority(exceptions[i].irq, priority);
+
+        for (uint32_t byte = 0; byte < 12; byte++)
+        {
+            uint32_t expected = (byte == exceptions[i].byte) ? priority << 4 : before[byte];
+            CHECK_EQ(scb.SHPR[byte], expected);
+        }
+        CHECK_EQ(NVIC_GetPriority(exceptions[i].irq), priority);
+    }
+
+    /* exceptions never touch the interrupt priorities */
+    for (uint32_t i = 0; i < sizeof(nvic.IPR); i++)
+    {
+        CHECK_EQ(nvic.IPR[i], 0);
+    }
+}
+
+/* AIRCR writes need the key 0x05FA in the upper half, PRIGROUP is bits 8-10 */
+static void test_grouping(void)
+{
+    /* reads return 0xFA05 in the upper half, and bit15 (ENDIANNESS) is a read-only 0 */
+    scb.AIRCR = 0xFA050000U;
+
+    for (uint32_t group = 0; group < 8; group++)
+    {
+        NVIC_SetPriorityGrouping(group);
+        CHECK_EQ(scb.AIRCR, 0x05FA0000U | (group << 8));
+        CHECK_EQ(NVIC_GetPriorityGrouping(), group);
+
+        scb.AIRCR = 0xFA050000U | (group << 8);
+    }
+
+    /* only 3 bits, the other fields are kept, the reset request bits are never set */
+    scb.AIRCR = 0xFA050000U;
+    NVIC_SetPriorityGrouping(0xFFU);
+    CHECK_EQ(scb.AIRCR, 0x05FA0700U);
+    CHECK_EQ(scb.AIRCR & (BIT(0) | BIT(1) | BIT(2)), 0);
+}
+
+/* split of the 4 priority bits into preemption and subpriority */
+static void test_encode(void)
+{
+    /* group 0-3: 4 bits of preemption, no subpriority */
+    for (uint32_t group = 0; group <= 3; group++)
+    {
+        CHECK_EQ(NVIC_EncodePriority(group, 5, 1), 5);
+        CHECK_EQ(NVIC_EncodePriority(group, 15, 0), 15);
+        CHECK_EQ(NVIC_EncodePriority(group, 16, 0), 0);
+    }
+
+    /* group 4: 3 bits preemption, 1 bit subpriority */
+    CHECK_EQ(NVIC_EncodePriority(4, 5, 1), (5U << 1) | 1U);
+    CHECK_EQ(NVIC_EncodePriority(4, 7, 3), (7U << 1) | 1U);
+    CHECK_EQ(NVIC_EncodePriority(4, 8, 0), 0);
+
+    /* group 5: 2 and 2 */
+    CHECK_EQ(NVIC_EncodePriority(5, 3, 2), (3U << 2) | 2U);
+    CHECK_EQ(NVIC_EncodePriority(5, 4, 4), 0);
+
+    /* group 6: 1 and 3 */
+    CHECK_EQ(NVIC_EncodePriority(6, 1, 5), (1U << 3) | 5U);
+
+    /* group 7: no preemption, 4 bits subpriority */
+    CHECK_EQ(NVIC_EncodePriority(7, 1, 9), 9);
+    CHECK_EQ(NVIC_EncodePriority(7, 0, 15), 15);
+
+    /* the encoded value always fits the implemented bits */
+    for (uint32_t group = 0; group < 8; group++)
+    {
+        for (uint32_t preempt = 0; preempt < 16; preempt++)
+        {
+            for (uint32_t sub = 0; sub < 16; sub++)
+            {
+                CHECK(NVIC_EncodePriority(group, preempt, sub) < (1U << NVIC_PRIO_BITS));
+            }
+        }
+    }
+}
+
+static void handler_a(void)
+{
+}
+
+static void handler_b(void)
+{
+}
+
+/* entry n + 16 of the table pointed to by VTOR */
+/* VTOR is 32 bits, so the table is mapped in the low 2 GB */
+static void test_vector(void)
+{
+    void (**table)(void) = mmap(NULL, 4096, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT, -1, 0);
+
+    if (table == MAP_FAILED)
+    {
+        printf("nvic: no memory below 2 GB, vector table not tested\n");
+        return;
+    }
+
+    scb.VTOR = (uint32_t)(uintptr_t)table;
+
+    NVIC_SetVector(USART2_IRQn, handler_a);
+    NVIC_SetVector(SysTick_IRQn, handler_b);
+    CHECK(table[USART2_IRQn + 16] == handler_a);
+    CHECK(table[15] == handler_b);
+    CHECK(NVIC_GetVector(USART2_IRQn) == handler_a);
+    CHECK(NVIC_GetVector(SysTick_IRQn) == handler_b);
+    CHECK(NVIC_GetVector(WWDG_IRQn) == NULL);
+
+    munmap(table, 4096);
+}
+
+int main(void)
+{
+    test_layout();
+    test_enable();
+    test_priority();
+    test_exception_priority();
+    test_grouping();
+    test_encode();
+    test_vector();
+
+    return test_result("nvic");
+}
\ No newline at end of file
@@ -0,0 +1,142 @@
+/* with the double free checks */
+#define POOL_DEBUG 1
+
+#include "tests/test.h"
+
+#include "services/src/pool.c"
+
+/* three size classes of 4 blocks each, smallest first */
+#define CLASSES 3U
+#define BLOCKS  4U
+
+static uint32_t small_storage[POOL_STORAGE_WORDS(8U, BLOCKS)];
+static uint32_t medium_storage[POOL_STORAGE_WORDS(32U, BLOCKS)];
+static uint32_t large_storage[POOL_STORAGE_WORDS(128U, BLOCKS)];
+static Pool pools[CLASSES];
+
+static void setup(void)
+{
+    POOL_Init(&pools[0], small_storage, 8U, BLOCKS);
+    POOL_Init(&pools[1], medium_storage, 32U, BLOCKS);
+    POOL_Init(&pools[2], large_storage, 128U, BLOCKS);
+}
+
+static uint8_t in_pool(const Pool *pool, const void *ptr)
+{
+    return (const uint8_t *)ptr >= pool->storage && (const uint8_t *)ptr < pool->end;
+}
+
+/* a block comes from the smallest class that fits, and a full class
+spills over into the next larger one */
+static void test_classes(void)
+{
+    setup();
+
+    CHECK(in_pool(&pools[0], POOL_Alloc_Class(pools, CLASSES, 1)));
+    CHECK(in_pool(&pools[0], POOL_Alloc_Class(pools, CLASSES, 8)));
+    CHECK(in_pool(&pools[1], POOL_Alloc_Class(pools, CLASSES, 9)));
+    CHECK(in_pool(&pools[2], POOL_Alloc_Class(pools, CLASSES, 128)));
+    CHECK(POOL_Alloc_Class(pools, CLASSES, 129) == NULL);
+
+    void *blocks[2 * BLOCKS];
+    for (uint32_t i = 0; i < 2U * BLOCKS; i++)
+    {
+        blocks[i] = POOL_Alloc_Class(pools, CLASSES, 4);
+    }
+
+    /* 2 left in the small class, 3 in the medium one, 3 in the large one */
+    CHECK(in_pool(&pools[0], blocks[1]));
+    CHECK(in_pool(&pools[1], blocks[2]));
+    CHECK(in_pool(&pools[1], blocks[4]));
+    CHECK(in_pool(&pools[2], blocks[5]));
+    CHECK(in_pool(&pools[2], blocks[7]));
+    CHECK(POOL_Alloc_Class(pools, CLASSES, 4) == NULL);
+    /* a request that spills over counts a failure in every class it tried */
+    CHECK_EQ(pools[0].stats.failed, 7);
+    CHECK_EQ(pools[1].stats.failed, 4);
+    CHECK_EQ(pools[2].stats.failed, 1);
+
+    /* every block goes back to the pool it came from */
+    for (uint32_t i = 0; i < 2U * BLOCKS; i++)
+    {
+        POOL_Free_Class(pools, CLASSES, blocks[i]);
+    }
+
+    CHECK_EQ(pools[0].stats.used, 2);
+    CHECK_EQ(pools[1].stats.used, 1);
+    CHECK_EQ(pools[2].stats.used, 1);
+    CHECK_EQ(pools[0].stats.bad_frees + pools[1].stats.bad_frees + pools[2].stats.bad_frees, 0);
+}
+
+/* pointers that are not blocks are counted and leave the pools alone */
+static void test_bad_frees(void)
+{
+    static uint32_t elsewhere[4];
+
+    setup();
+    void *block = POOL_Alloc_Class(pools, CLASSES, 20);
+    CHECK(in_pool(&pools[1], block));
+
+    /* in none of the pools, counted by the first one */
+    POOL_Free_Class(pools, CLASSES, elsewhere);
+    POOL_Free_Class(pools, CLASSES, &elsewhere[2]);
+    CHECK_EQ(pools[0].stats.bad_frees, 2);
+    CHECK_EQ(pools[1].stats.bad_frees, 0);
+    CHECK_EQ(pools[2].stats.bad_frees, 0);
+
+    /* NULL and no pools at all are ignored */
+    POOL_Free_Class(pools, CLASSES, NULL);
+    POOL_Free_Class(pools, 0, elsewhere);
+    CHECK_EQ(pools[0].stats.bad_frees, 2);
+
+    /* inside a pool, into the middle of a block or freed twice, counted
+    by that pool */
+    POOL_Free_Class(pools, CLASSES, (uint8_t *)block + 4);
+    POOL_Free_Class(pools, CLASSES, block);
+    POOL_Free_Class(pools, CLASSES, block);
+    CHECK_EQ(pools[1].stats.bad_frees, 2);
+    CHECK_EQ(pools[1].stats.used, 0);
+    CHECK_EQ(pools[0].stats.bad_frees, 2);
+
+    /* the free lists are still whole */
+    for (uint32_t i = 0; i < CLASSES; i++)
+    {
+        for (uint32_t n = 0; n < BLOCKS; n++)
+        {
+            CHECK(in_pool(&pools[i], POOL_Alloc(&pools[i])));
+        }
+        CHECK(POOL_Alloc(&pools[i]) == NULL);
+    }
+}
+
+/* a pool larger than the debug bitmap is refused, not made smaller */
+static void test_debug_limit(void)
+{
+    static uint32_t storage[POOL_STORAGE_WORDS(8U, POOL_DEBUG_MAX_BLOCKS + 1U)];
+    static Pool pool;
+    Pool_Stats stats;
+
+    POOL_Init(&pool, storage, 8U, POOL_DEBUG_MAX_BLOCKS + 1U);
+    POOL_Get_Stats(&pool, &stats);
+    CHECK_EQ(stats.blocks, 0);
+    CHECK(POOL_Alloc(&pool) == NULL);
+    CHECK_EQ(pool.stats.failed, 1);
+
+    /* the largest pool that fits is complete */
+    POOL_Init(&pool, storage, 8U, POOL_DEBUG_MAX_BLOCKS);
+    for (uint32_t i = 0; i < POOL_DEBUG_MAX_BLOCKS; i++)
+    {
+        CHECK(POOL_Alloc(&pool) != NULL);
+    }
+    CHECK(POOL_Alloc(&pool) == NULL);
+    CHECK_EQ(pool.stats.used, POOL_DEBUG_MAX_BLOCKS);
+}
+
+int main(void)
+{
+    test_classes();
+    test_bad_frees();
+    test_debug_limit();
+
+    return test_result("pool");
+}
\ No newline at end of file
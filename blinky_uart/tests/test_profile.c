@@ -0,0 +1,142 @@
+#include "tests/test.h"
+
+#include <stdint.h>
+#include <string.h>
+
+/* the profiler on a fake cycle counter, moved by the tests */
+#define PROFILING 1
+
+static uint32_t fake_cycles;
+#define PROFILE_CYCLES() (fake_cycles)
+
+#include "services/src/format.c"
+#include "services/src/profile.c"
+
+/* PROFILE_Dump prints through USART_Transmit_Async, this one keeps the text */
+static char output[512];
+static size_t output_len;
+
+size_t USART_Transmit_Async(USART_Peripheral *usartx, const char *data, size_t len)
+{
+    (void)usartx;
+
+    /* room for a few bytes at a time, like a nearly full transmit ring */
+    if (len > 7U) len = 7U;
+    if (len > sizeof(output) - 1U - output_len) len = sizeof(output) - 1U - output_len;
+
+    memcpy(&output[output_len], data, len);
+    output_len += len;
+    output[output_len] = '\0';
+
+    return len;
+}
+
+/* a profiled block that takes a number of cycles */
+static void profiled(uint32_t cycles)
+{
+    PROFILE_BEGIN(USART2_IRQ);
+    fake_cycles += cycles;
+    PROFILE_END(USART2_IRQ);
+}
+
+/* count, min, max and total of a site, other sites untouched */
+static void test_stats(void)
+{
+    Profile_Stats entry;
+
+    PROFILE_Reset();
+    fake_cycles = 1000U;
+
+    profiled(50);
+    profiled(20);
+    profiled(300);
+    profiled(20);
+
+    PROFILE_Get_Stats(PROFILE_SITE_USART2_IRQ, &entry);
+    CHECK_EQ(entry.count, 4);
+    CHECK_EQ(entry.min, 20);
+    CHECK_EQ(entry.max, 300);
+    CHECK_EQ(entry.total, 390);
+
+    PROFILE_Get_Stats(PROFILE_SITE_SYSTICK_IRQ, &entry);
+    CHECK_EQ(entry.count, 0);
+    CHECK_EQ(entry.total, 0);
+
+    /* a block that takes no cycles is the new min */
+    profiled(0);
+    PROFILE_Get_Stats(PROFILE_SITE_USART2_IRQ, &entry);
+    CHECK_EQ(entry.count, 5);
+    CHECK_EQ(entry.min, 0);
+
+    /* invalid sites are ignored */
+    PROFILE_Record(PROFILE_SITE_COUNT, 5);
+    entry.count = 1234U;
+    PROFILE_Get_Stats(PROFILE_SITE_COUNT, &entry);
+    CHECK_EQ(entry.count, 1234);
+
+    PROFILE_Reset();
+    PROFILE_Get_Stats(PROFILE_SITE_USART2_IRQ, &entry);
+    CHECK_EQ(entry.count, 0);
+    CHECK_EQ(entry.max, 0);
+}
+
+/* the counter wraps during a measurement, the difference is still right */
+static void test_wrap(void)
+{
+    Profile_Stats entry;
+
+    PROFILE_Reset();
+
+    fake_cycles = 0xFFFFFFF0U;
+    profiled(0x20);
+    CHECK_EQ(fake_cycles, 0x10);
+
+    fake_cycles = 0xFFFFFFFFU;
+    profiled(1);
+
+    fake_cycles = 0x80000000U;
+    profiled(0xFFFFFFFFU); // the longest measurement that fits
+
+    PROFILE_Get_Stats(PROFILE_SITE_USART2_IRQ, &entry);
+    CHECK_EQ(entry.count, 3);
+    CHECK_EQ(entry.min, 1);
+    CHECK_EQ(entry.max, 0xFFFFFFFFU);
+    CHECK_EQ(entry.total, 0x20ULL + 1ULL + 0xFFFFFFFFULL);
+
+    /* the total does not wrap with the 32-bit counter */
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        profiled(0xF0000000U);
+    }
+    PROFILE_Get_Stats(PROFILE_SITE_USART2_IRQ, &entry);
+    CHECK_EQ(entry.total, 0x20ULL + 1ULL + 0xFFFFFFFFULL + 4ULL * 0xF0000000ULL);
+}
+
+/* one line per site that was reached, with the mean rounded down */
+static void test_dump(void)
+{
+    PROFILE_Reset();
+    fake_cycles = 0;
+
+    profiled(10);
+    profiled(15);
+
+    PROFILE_BEGIN(SYSTICK_IRQ);
+    fake_cycles += 7U;
+    PROFILE_END(SYSTICK_IRQ);
+
+    output_len = 0;
+    PROFILE_Dump(NULL);
+
+    CHECK(strcmp(output, "SYSTICK_IRQ count=1 min=7 max=7 mean=7\r\n"
+                         "USART2_IRQ count=2 min=10 max=15 mean=12\r\n") == 0);
+}
+
+int main(void)
+{
+    test_stats();
+    test_wrap();
+    test_dump();
+
+    return test_result("profile");
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#include "tests/test.h"
+
+#include <stdint.h>
+
+/* the profiler compiled out, the macros must not read the cycle counter
+or record anything. profile.c has no functions in this build, so a macro
+that still called PROFILE_Record would not link */
+#define PROFILING 0
+
+static uint32_t counter_reads;
+#define PROFILE_CYCLES() (counter_reads++, 0U)
+
+#include "services/src/profile.c"
+
+static uint32_t work;
+
+static void profiled(void)
+{
+    PROFILE_BEGIN(USART2_IRQ);
+    work++;
+    PROFILE_END(USART2_IRQ);
+}
+
+int main(void)
+{
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        profiled();
+    }
+
+    CHECK_EQ(work, 10);
+    CHECK_EQ(counter_reads, 0);
+
+    return test_result("profile off");
+}
\ No newline at end of file
@@ -0,0 +1,271 @@
+#include "tests/test.h"
+
+#include "services/include/queue.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+/* every item says who pushed it and where it is in that producer's order */
+typedef struct
+{
+    uint32_t producer;
+    uint32_t seq;
+} Item;
+
+/* small queues, so the producers find them full and the consumer finds
+them empty all the time */
+#define QUEUE_SIZE 8U
+
+QUEUE_SPSC_DEFINE(Item_SPSC, Item, QUEUE_SIZE)
+QUEUE_MPSC_DEFINE(Item_MPSC, Item, QUEUE_SIZE)
+
+/* full and empty at the edges, in order across the wrap of the counters */
+static void test_spsc_bounds(void)
+{
+    static Item_SPSC queue;
+    Item item = { 0 };
+
+    queue.head = 0xFFFFFFFCU;
+    queue.tail = 0xFFFFFFFCU;
+    CHECK(Item_SPSC_Empty(&queue));
+    CHECK(!Item_SPSC_Pop(&queue, &item));
+
+    for (uint32_t round = 0; round < 3; round++)
+    {
+        for (uint32_t i = 0; i < QUEUE_SIZE; i++)
+        {
+            item.seq = round * 100U + i;
+            CHECK(Item_SPSC_Push(&queue, &item));
+        }
+        CHECK(!Item_SPSC_Push(&queue, &item));
+        CHECK(!Item_SPSC_Empty(&queue));
+
+        for (uint32_t i = 0; i < QUEUE_SIZE; i++)
+        {
+            CHECK(Item_SPSC_Pop(&queue, &item));
+            CHECK_EQ(item.seq, round * 100U + i);
+        }
+        CHECK(!Item_SPSC_Pop(&queue, &item));
+        CHECK(Item_SPSC_Empty(&queue));
+    }
+}
+
+static void test_mpsc_bounds(void)
+{
+    static Item_MPSC queue;
+    Item item = { 0 };
+
+    /* an empty queue whose positions are about to wrap, every slot waits
+    for the position that maps to it */
+    uint32_t base = 0xFFFFFFFCU;
+    for (uint32_t i = 0; i < QUEUE_SIZE; i++)
+    {
+        queue.slots[i].seq = base + ((i - base) & (QUEUE_SIZE - 1U));
+    }
+    queue.head = base;
+    queue.tail = base;
+    CHECK(Item_MPSC_Empty(&queue));
+    CHECK(!Item_MPSC_Pop(&queue, &item));
+
+    for (uint32_t round = 0; round < 3; round++)
+    {
+        for (uint32_t i = 0; i < QUEUE_SIZE; i++)
+        {
+            item.seq = round * 100U + i;
+            CHECK(Item_MPSC_Push(&queue, &item));
+        }
+        CHECK(!Item_MPSC_Push(&queue, &item));
+        CHECK(!Item_MPSC_Empty(&queue));
+
+        for (uint32_t i = 0; i < QUEUE_SIZE; i++)
+        {
+            CHECK(Item_MPSC_Pop(&queue, &item));
+            CHECK_EQ(item.seq, round * 100U + i);
+        }
+        CHECK(!Item_MPSC_Pop(&queue, &item));
+        CHECK(Item_MPSC_Empty(&queue));
+    }
+
+    /* a freshly set up queue is the same as one at position 0 */
+    Item_MPSC_Init(&queue);
+    CHECK(Item_MPSC_Empty(&queue));
+    item.seq = 7;
+    CHECK(Item_MPSC_Push(&queue, &item));
+    CHECK(Item_MPSC_Pop(&queue, &item));
+    CHECK_EQ(item.seq, 7);
+}
+
+/* threads stand in for interrupts: producers push from several threads at
+once and the consumer pops from another. a producer that finds the queue
+full and a consumer that finds it empty give up the cpu and try again, so
+the test also runs on a single core */
+#define PRODUCERS     4U
+#define ITEMS_MPSC    200000U
+#define ITEMS_SPSC    500000U
+#define STALL_LIMIT   100000U // empty pops in a row before the consumer gives up
+
+static Item_SPSC spsc;
+static Item_MPSC mpsc;
+
+/* set when items went missing and the queue stays empty for the consumer,
+the producers stop waiting for room too */
+static volatile uint8_t stalled;
+
+typedef struct
+{
+    uint32_t producer;
+    uint32_t count;
+    uint32_t full; // pushes refused because the queue was full
+} Producer;
+
+static void *produce_spsc(void *arg)
+{
+    Producer *producer = arg;
+
+    for (uint32_t i = 0; i < producer->count; i++)
+    {
+        Item item = { producer->producer, i };
+
+        while (!Item_SPSC_Push(&spsc, &item))
+        {
+            if (stalled) return NULL;
+            producer->full++;
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+static void *produce_mpsc(void *arg)
+{
+    Producer *producer = arg;
+
+    for (uint32_t i = 0; i < producer->count; i++)
+    {
+        Item item = { producer->producer, i };
+
+        while (!Item_MPSC_Push(&mpsc, &item))
+        {
+            if (stalled) return NULL;
+            producer->full++;
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+/* every producer's items arrive once each and in the order they were
+pushed, whatever the interleaving between the producers */
+static void check_consumed(uint8_t (*pop)(Item *), uint32_t producers, uint32_t count)
+{
+    uint32_t next[PRODUCERS] = { 0 };
+    uint32_t received = 0;
+    uint32_t foreign = 0;
+    uint32_t out_of_order = 0;
+    uint32_t empty = 0;
+    uint32_t idle = 0;
+    Item item;
+
+    stalled = 0;
+
+    while (received < producers * count)
+    {
+        if (!pop(&item))
+        {
+            if (++idle > STALL_LIMIT)
+            {
+                stalled = 1;
+                break;
+            }
+
+            empty++;
+            sched_yield();
+            continue;
+        }
+
+        idle = 0;
+        received++;
+
+        if (item.producer >= producers)
+        {
+            foreign++;
+        }
+        else if (item.seq != next[item.producer]++)
+        {
+            out_of_order++;
+        }
+    }
+
+    CHECK_EQ(stalled, 0);
+    CHECK_EQ(foreign, 0);
+    CHECK_EQ(out_of_order, 0);
+    for (uint32_t p = 0; p < producers; p++)
+    {
+        CHECK_EQ(next[p], count);
+    }
+
+    /* nothing was left behind or pushed twice */
+    CHECK(!pop(&item));
+    CHECK(empty > 0);
+}
+
+static uint8_t pop_spsc(Item *item)
+{
+    return Item_SPSC_Pop(&spsc, item);
+}
+
+static uint8_t pop_mpsc(Item *item)
+{
+    return Item_MPSC_Pop(&mpsc, item);
+}
+
+static void test_spsc_threads(void)
+{
+    pthread_t thread;
+    Producer producer = { 0, ITEMS_SPSC, 0 };
+
+    pthread_create(&thread, NULL, produce_spsc, &producer);
+    check_consumed(pop_spsc, 1, ITEMS_SPSC);
+    pthread_join(thread, NULL);
+
+    CHECK(producer.full > 0);
+    CHECK(Item_SPSC_Empty(&spsc));
+}
+
+static void test_mpsc_threads(void)
+{
+    pthread_t threads[PRODUCERS];
+    Producer producers[PRODUCERS];
+    uint32_t full = 0;
+
+    Item_MPSC_Init(&mpsc);
+
+    for (uint32_t p = 0; p < PRODUCERS; p++)
+    {
+        producers[p] = (Producer){ p, ITEMS_MPSC, 0 };
+        pthread_create(&threads[p], NULL, produce_mpsc, &producers[p]);
+    }
+
+    check_consumed(pop_mpsc, PRODUCERS, ITEMS_MPSC);
+
+    for (uint32_t p = 0; p < PRODUCERS; p++)
+    {
+        pthread_join(threads[p], NULL);
+        full += producers[p].full;
+    }
+
+    CHECK(full > 0);
+    CHECK(Item_MPSC_Empty(&mpsc));
+}
+
+int main(void)
+{
+    test_spsc_bounds();
+    test_mpsc_bounds();
+    test_spsc_threads();
+    test_mpsc_threads();
+
+    return test_result("queue");
+}
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include "tests/test.h"
+
+#include "drivers/src/flash.c"
+#include "drivers/src/pwr.c"
+#include "drivers/src/rcc.c"
+
+/* the configuration used by main: hsi / 8 * 180 / 2 = 180 MHz */
+static const RCC_Clock_Config hsi_180 = {
+    .source      = RCC_PLL_SOURCE_HSI,
+    .source_freq = RCC_HSI_FREQ,
+    .hse_bypass  = 0,
+    .pllm        = 8,
+    .plln        = 180,
+    .pllp        = 2,
+    .pllq        = 8,
+    .ahb_div     = 1,
+    .apb1_div    = 4,
+    .apb2_div    = 2
+};
+
+static void test_clocks_180(void)
+{
+    RCC_Clocks result = { 0 };
+
+    CHECK_EQ(RCC_Calc_Clocks(&hsi_180, &result), RCC_OK);
+    CHECK_EQ(result.sysclk, 180000000U);
+    CHECK_EQ(result.hclk, 180000000U);
+    CHECK_EQ(result.pclk1, 45000000U);
+    CHECK_EQ(result.pclk2, 90000000U);
+    CHECK_EQ(RCC_Calc_Flash_Latency(result.hclk), 5);
+}
+
+/* the apb1 timers run at twice pclk1 unless apb1 is not divided */
+static void test_timer_clock(void)
+{
+    RCC_Clock_Config config = hsi_180;
+    RCC_Clocks result;
+
+    CHECK_EQ(RCC_Calc_Clocks(&config, &result), RCC_OK);
+    clocks = result;
+    CHECK_EQ(RCC_Get_PCLK1_Freq(), 45000000U);
+    CHECK_EQ(RCC_Get_PCLK2_Freq(), 90000000U);
+    CHECK_EQ(RCC_Get_APB1_Timer_Freq(), 90000000U);
+
+    /* 180 / 4 = 45 MHz on ahb, apb1 undivided */
+    config.ahb_div = 4;
+    config.apb1_div = 1;
+    config.apb2_div = 1;
+    CHECK_EQ(RCC_Calc_Clocks(&config, &result), RCC_OK);
+    clocks = result;
+    CHECK_EQ(RCC_Get_HCLK_Freq(), 45000000U);
+    CHECK_EQ(RCC_Get_PCLK1_Freq(), 45000000U);
+    CHECK_EQ(RCC_Get_PCLK2_Freq(), 45000000U);
+    CHECK_EQ(RCC_Get_APB1_Timer_Freq(), 45000000U);
+
+    config.apb1_div = 16;
+    CHECK_EQ(RCC_Calc_Clocks(&config, &result), RCC_OK);
+    clocks = result;
+    CHECK_EQ(RCC_Get_PCLK1_Freq(), 2812500U);
+    CHECK_EQ(RCC_Get_APB1_Timer_Freq(), 5625000U);
+}
+
+/* configurations outside the limits are refused and the output is not touched */
+static void test_invalid(void)
+{
+    RCC_Clocks result = { 1U, 2U, 3U, 4U };
+    RCC_Clock_Config config;
+
+    config = hsi_180;
+    config.apb1_div = 2; // pclk1 90 MHz
+    CHECK_EQ(RCC_Calc_Clocks(&config, &result), RCC_ERROR);
+
+    config = hsi_180;
+    config.apb2_div = 1; // pclk2 180 MHz
+    CHECK_EQ(RCC_Calc_Clocks(&config, &result), RCC_ERROR);
+
+    config = hsi_180;
+    config.plln = 192; // 192 MHz
+    CHECK_EQ(RCC_Calc_Clocks(&config, &result), RCC_ERROR);
+
+    config = hsi_180;
+    config.pllm = 4; // vco input 4 MHz
+    CHECK_EQ(RCC_Calc_Clocks(&config, &result), RCC_ERROR);
+
+    config = hsi_180;
+    config.plln = 49;
+    CHECK_EQ(RCC_Calc_Clocks(&config, &result), RCC_ERROR);
+
+    config = hsi_180;
+    config.pllp = 3;
+    CHECK_EQ(RCC_Calc_Clocks(&config, &result), RCC_ERROR);
+
+    config = hsi_180;
+    config.ahb_div = 32; // there is no divide by 32
+    CHECK_EQ(RCC_Calc_Clocks(&config, &result), RCC_ERROR);
+
+    config = hsi_180;
+    config.apb1_div = 3;
+    CHECK_EQ(RCC_Calc_Clocks(&config, &result), RCC_ERROR);
+
+    CHECK_EQ(result.sysclk, 1U);
+    CHECK_EQ(result.pclk2, 4U);
+
+    /* vco output 432 MHz is the upper limit */
+    config = hsi_180;
+    config.plln = 216;
+    config.pllp = 4;
+    config.pllq = 9;
+    CHECK_EQ(RCC_Calc_Clocks(&config, &result), RCC_OK);
+    CHECK_EQ(result.sysclk, 108000000U);
+    config.plln = 217;
+    CHECK_EQ(RCC_Calc_Clocks(&config, &result), RCC_ERROR);
+}
+
+/* one wait state per 30 MHz: up to 30 MHz needs 0, above 30 up to 60 needs 1, ... */
+static void test_flash_latency(void)
+{
+    CHECK_EQ(RCC_Calc_Flash_Latency(0), 0);
+    CHECK_EQ(RCC_Calc_Flash_Latency(RCC_HSI_FREQ), 0);
+
+    for (uint32_t ws = 0; ws < 6; ws++)
+    {
+        uint32_t limit = (ws + 1U) * 30000000U;
+
+        CHECK_EQ(RCC_Calc_Flash_Latency(limit), ws);
+        CHECK_EQ(RCC_Calc_Flash_Latency(limit - 1U), ws);
+        CHECK_EQ(RCC_Calc_Flash_Latency(limit + 1U), ws + 1U);
+        CHECK_EQ(RCC_Calc_Flash_Latency(limit - 29999999U), ws);
+    }
+}
+
+int main(void)
+{
+    test_clocks_180();
+    test_timer_clock();
+    test_invalid();
+    test_flash_latency();
+
+    return test_result("rcc");
+}
\ No newline at end of file
@@ -0,0 +1,166 @@
+#include "tests/test.h"
+
+#include "services/src/sched.c"
+
+#include <time.h>
+
+/* order the handlers ran in */
+static uint32_t ran[64];
+static uint32_t ran_count;
+
+static void record(uint32_t arg)
+{
+    if (ran_count < 64) ran[ran_count++] = arg;
+}
+
+static void nothing(uint32_t arg)
+{
+    (void)arg;
+}
+
+static void run_all(void)
+{
+    while (SCHED_Dispatch()) {}
+}
+
+/* highest priority first, in posting order within a priority */
+static void test_order(void)
+{
+    SCHED_Init();
+    ran_count = 0;
+
+    CHECK(SCHED_Post(1, record, 10));
+    CHECK(SCHED_Post(5, record, 50));
+    CHECK(SCHED_Post(1, record, 11));
+    CHECK(SCHED_Post(7, record, 70));
+    CHECK(SCHED_Post(0, record, 0));
+    CHECK(SCHED_Post(5, record, 51));
+
+    run_all();
+
+    static const uint32_t expected[] = { 70, 50, 51, 10, 11, 0 };
+    CHECK_EQ(ran_count, 6);
+    for (uint32_t i = 0; i < 6; i++)
+    {
+        CHECK_EQ(ran[i], expected[i]);
+    }
+
+    CHECK_EQ(ready, 0);
+    CHECK(!SCHED_Dispatch());
+}
+
+/* a full queue and invalid events are refused */
+static void test_refused(void)
+{
+    SCHED_Init();
+    ran_count = 0;
+
+    for (uint32_t i = 0; i < SCHED_QUEUE_SIZE; i++)
+    {
+        CHECK(SCHED_Post(3, record, i));
+    }
+    CHECK(!SCHED_Post(3, record, 99));
+    CHECK(SCHED_Post(2, record, 20));
+
+    CHECK(!SCHED_Post(SCHED_PRIORITIES, record, 0));
+    CHECK(!SCHED_Post(0, NULL, 0));
+
+    run_all();
+    CHECK_EQ(ran_count, SCHED_QUEUE_SIZE + 1U);
+    CHECK_EQ(ran[SCHED_QUEUE_SIZE - 1U], SCHED_QUEUE_SIZE - 1U);
+    CHECK_EQ(ran[SCHED_QUEUE_SIZE], 20);
+}
+
+/* a handler posting to its own priority runs the new event after the others */
+static void repost(uint32_t arg)
+{
+    record(arg);
+
+    if (arg < 3)
+    {
+        SCHED_Post(4, repost, arg + 1U);
+    }
+}
+
+static void test_repost(void)
+{
+    SCHED_Init();
+    ran_count = 0;
+
+    SCHED_Post(4, repost, 0);
+    SCHED_Post(4, record, 100);
+    run_all();
+
+    static const uint32_t expected[] = { 0, 100, 1, 2, 3 };
+    CHECK_EQ(ran_count, 5);
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        CHECK_EQ(ran[i], expected[i]);
+    }
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+}
+
+/* cost of posting and dispatching an event */
+/* host timings, only the relation between the numbers carries over to the target */
+#define ROUNDS 200000U
+
+static void bench(void)
+{
+    uint64_t start;
+    uint64_t post = 0;
+    uint64_t dispatch = 0;
+
+    SCHED_Init();
+
+    /* fill every queue and empty them again, highest priority first */
+    for (uint32_t round = 0; round < ROUNDS / (SCHED_PRIORITIES * SCHED_QUEUE_SIZE); round++)
+    {
+        start = now_ns();
+        for (uint32_t priority = 0; priority < SCHED_PRIORITIES; priority++)
+        {
+            for (uint32_t i = 0; i < SCHED_QUEUE_SIZE; i++)
+            {
+                SCHED_Post((uint8_t)priority, nothing, i);
+            }
+        }
+        post += now_ns() - start;
+
+        start = now_ns();
+        run_all();
+        dispatch += now_ns() - start;
+    }
+
+    uint32_t events = (ROUNDS / (SCHED_PRIORITIES * SCHED_QUEUE_SIZE)) * SCHED_PRIORITIES * SCHED_QUEUE_SIZE;
+
+    /* one event at a time, the usual case of an interrupt posting to an idle loop */
+    start = now_ns();
+    for (uint32_t i = 0; i < ROUNDS; i++)
+    {
+        SCHED_Post(3, nothing, i);
+        SCHED_Dispatch();
+    }
+    uint64_t single = now_ns() - start;
+
+    /* the ready bit of a drained queue is only cleared by the next dispatch */
+    CHECK(!SCHED_Dispatch());
+    CHECK_EQ(ready, 0);
+
+    printf("sched: post %.1f ns, dispatch %.1f ns (all queues full), post and dispatch %.1f ns (one event)\n",
+           (double)post / events, (double)dispatch / events, (double)single / ROUNDS);
+}
+
+int main(void)
+{
+    test_order();
+    test_refused();
+    test_repost();
+    bench();
+
+    return test_result("sched");
+}
\ No newline at end of file
@@ -0,0 +1,193 @@
+/* for tests/trap.h */
+#define _GNU_SOURCE
+
+#include "tests/test.h"
+#include "tests/trap.h"
+
+#include "drivers/include/systick.h"
+#include "drivers/include/scb.h"
+
+#include <stddef.h>
+
+/* fake systick timer and system control block, both in a trapped page so
+the counter can keep counting between two reads of the driver */
+static SYSTICK_Peripheral *systick;
+static SCB_Peripheral *scb;
+
+#undef SYSTICK
+#define SYSTICK systick
+#undef SCB
+#define SCB scb
+
+#include "drivers/src/systick.c"
+
+#define TICK_CYCLES 1000U
+#define SCB_OFFSET  0x100U
+
+/* simulated hardware, changed by the access handler behind the compiler's back */
+static volatile uint64_t cycles;      // true time in clock cycles
+static volatile uint8_t pending;      // systick interrupt pending (PENDSTSET)
+static volatile uint8_t masked;       // interrupts disabled with PRIMASK
+static volatile uint8_t running;      // the counter only counts while the driver runs
+static uint32_t max_step;             // most cycles between two register accesses
+static volatile uint32_t lost_ticks;  // wraps while the interrupt was already pending
+static uint64_t last_now;             // latest time read in thread mode or by the handler
+static uint32_t handler_wrong;        // times read by the handler that were off
+
+/* the current value counts down from the reload value to 0, and the
+interrupt becomes pending when it wraps */
+static void update_registers(void)
+{
+    systick->SYST_CVR = (TICK_CYCLES - 1U) - (uint32_t)(cycles % TICK_CYCLES);
+    scb->ICSR = pending ? BIT(26) : 0U;
+}
+
+static void advance(uint32_t count)
+{
+    uint64_t wraps = (cycles + count) / TICK_CYCLES - cycles / TICK_CYCLES;
+
+    cycles += count;
+
+    if (wraps > 0)
+    {
+        lost_ticks += (uint32_t)wraps - (pending ? 0U : 1U);
+        pending = 1;
+    }
+}
+
+/* the systick interrupt runs as soon as it is pending and not masked */
+/* like SysTick_Handler it counts the tick first, then reads the time as a
+timer callback running in the tick would. that time is exact and never
+behind a time read in thread mode while the interrupt was pending */
+static void take_interrupt(void)
+{
+    if (pending && !masked)
+    {
+        pending = 0;
+        SYSTICK_Inc_Ticks();
+        update_registers();
+
+        uint64_t now = SYSTICK_Now();
+        if (now != cycles || now < last_now) handler_wrong++;
+        last_now = now;
+    }
+}
+
+/* time passes before every access of the driver, and the interrupt may
+run right before it, between two instructions of the driver */
+static void on_access(uintptr_t offset, uint8_t write)
+{
+    (void)offset;
+    (void)write;
+
+    if (!running) return;
+
+    advance(1U + (uint32_t)rand() % max_step);
+
+    if (rand() % 2)
+    {
+        take_interrupt();
+    }
+
+    update_registers();
+}
+
+static void setup(uint32_t step)
+{
+    running = 0;
+    SYSTICK_Init(TICK_CYCLES * 1000U, SYSTICK_MS);
+
+    ticks = 0;
+    cycles = 0;
+    pending = 0;
+    masked = 0;
+    lost_ticks = 0;
+    last_now = 0;
+    handler_wrong = 0;
+    max_step = step;
+    update_registers();
+}
+
+/* SYSTICK_Now is never behind the time before the call, never ahead of
+the time after it, and never goes backwards, wherever the counter wraps
+and whether or not the interrupt gets to count the wrap in between */
+static void run_now(uint32_t calls, uint32_t step, uint8_t mask_rate)
+{
+    setup(step);
+
+    uint32_t backwards = 0;
+    uint32_t early = 0;
+    uint32_t late = 0;
+
+    for (uint32_t i = 0; i < calls; i++)
+    {
+        /* some calls run with interrupts disabled, as in an interrupt
+        handler of a higher priority or a critical section */
+        masked = (uint8_t)((uint32_t)rand() % 100U < mask_rate);
+
+        advance((uint32_t)rand() % (2U * step));
+        update_registers();
+
+        uint64_t before = cycles;
+        running = 1;
+        uint64_t now = SYSTICK_Now();
+        running = 0;
+        uint64_t after = cycles;
+
+        if (now < last_now) backwards++;
+        if (now < before) early++;
+        if (now > after) late++;
+        last_now = now;
+
+        masked = 0;
+        take_interrupt();
+        update_registers();
+    }
+
+    CHECK_EQ(backwards, 0);
+    CHECK_EQ(early, 0);
+    CHECK_EQ(late, 0);
+    CHECK_EQ(lost_ticks, 0);
+    CHECK_EQ(handler_wrong, 0);
+    CHECK_EQ(SYSTICK_Get_Ticks(), cycles / TICK_CYCLES);
+}
+
+static void test_now(void)
+{
+    /* a few register accesses per tick, a wrap between any two reads is likely */
+    run_now(10000, TICK_CYCLES / 8U, 0);
+    run_now(10000, TICK_CYCLES / 8U, 50);
+    run_now(10000, TICK_CYCLES / 8U, 100);
+
+    /* slow time, the calls mostly see the counter in the same tick */
+    run_now(5000, 3, 30);
+}
+
+/* cycles into the current tick */
+static void test_elapsed(void)
+{
+    setup(1);
+
+    CHECK_EQ(SYSTICK_Get_Tick_Cycles(), TICK_CYCLES);
+    CHECK_EQ(SYSTICK_Get_Tick_Elapsed(), 0);
+
+    advance(TICK_CYCLES + 123U);
+    update_registers();
+    CHECK_EQ(SYSTICK_Get_Tick_Elapsed(), 123);
+    CHECK_EQ(SYSTICK_Get_Ticks(), 0); // the interrupt has not run yet
+    take_interrupt();
+    CHECK_EQ(SYSTICK_Get_Ticks(), 1);
+}
+
+int main(void)
+{
+    uint8_t *page = trap_map(on_access);
+    systick = (SYSTICK_Peripheral *)page;
+    scb = (SCB_Peripheral *)(page + SCB_OFFSET);
+
+    srand(1);
+    test_now();
+    test_elapsed();
+
+    return test_result("systick");
+}
\ No newline at end of file
@@ -0,0 +1,338 @@
+/* for tests/trap.h */
+#define _GNU_SOURCE
+
+#include "tests/test.h"
+#include "tests/trap.h"
+
+#include "drivers/include/systick.h"
+#include "drivers/include/scb.h"
+
+#include <stddef.h>
+#include <string.h>
+
+/* fake systick timer and system control block in a trapped page, so the
+counter keeps counting between the accesses of SYSTICK_Sleep and sees the
+reload and current values in the order the driver writes them */
+static SYSTICK_Peripheral *systick;
+static SCB_Peripheral *scb;
+
+#undef SYSTICK
+#define SYSTICK systick
+#undef SCB
+#define SCB scb
+
+/* the sleep itself, time passes until the counter wraps or another
+interrupt comes in */
+static void sim_wfi(void);
+#define wait_for_interrupt() sim_wfi()
+
+#include "drivers/src/systick.c"
+#include "services/src/timer.c"
+
+#define TICK_CYCLES 180000U                    // 1 ms ticks at 180 MHz, as on the board
+#define SECOND      (1000ULL * TICK_CYCLES)
+#define SCB_OFFSET  0x100U
+
+/* simulated hardware, changed by the access handler behind the compiler's back */
+static volatile uint64_t cycles;      // true time in clock cycles
+static volatile uint32_t current;     // current value of the counter
+static volatile uint32_t reload;      // reload value the counter picks up after reaching 0
+static volatile uint8_t enabled;      // counter running (bit0 in CSR)
+static volatile uint8_t pending;      // systick interrupt pending (PENDSTSET)
+static volatile uint8_t running;      // time passes at every access while the driver runs
+static volatile uint8_t cvr_written;  // the last access wrote the current value
+static volatile uint8_t in_model;     // the simulation itself accesses the registers
+static volatile uint32_t lost_ticks;  // wraps while the interrupt was already pending
+static uint64_t other_irq_at;         // next interrupt that is not systick
+
+/* the counter counts down to 0 and loads the reload value on the next
+clock, the interrupt becomes pending when it goes from 1 to 0. a write
+to the current value clears it without an interrupt */
+static void count(uint64_t count_cycles)
+{
+    cycles += count_cycles;
+
+    while (count_cycles > 0 && enabled)
+    {
+        if (current == 0)
+        {
+            if (reload == 0) break; // a reload value of 0 stops the counter
+            current = reload;
+            count_cycles--;
+            continue;
+        }
+
+        uint64_t step = count_cycles < current ? count_cycles : current;
+        current -= (uint32_t)step;
+        count_cycles -= step;
+
+        if (current == 0)
+        {
+            if (pending) lost_ticks++;
+            pending = 1;
+        }
+    }
+}
+
+/* pick up what the driver wrote with its last access */
+static void update(void)
+{
+    in_model = 1;
+    enabled = (uint8_t)(systick->SYST_CSR & BIT(0));
+    reload = systick->SYST_RVR & SYSTICK_MAX_RELOAD;
+
+    if (cvr_written)
+    {
+        cvr_written = 0;
+        current = 0;
+    }
+
+    systick->SYST_CVR = current;
+    scb->ICSR = pending ? BIT(26) : 0U;
+    in_model = 0;
+}
+
+/* every access of the driver takes a few cycles */
+static void on_access(uintptr_t offset, uint8_t write)
+{
+    if (in_model) return;
+
+    update();
+
+    if (running)
+    {
+        count(1U + (uint32_t)rand() % 4U);
+        update();
+    }
+
+    cvr_written = write && offset == offsetof(SYSTICK_Peripheral, SYST_CVR);
+}
+
+/* wfi also wakes up on a pending interrupt that is masked */
+static uint32_t wakeups;
+
+static void sim_wfi(void)
+{
+    update();
+
+    if (!pending && cycles < other_irq_at)
+    {
+        uint64_t to_wrap = (current == 0) ? reload + 1ULL : current;
+        uint64_t to_other = other_irq_at - cycles;
+
+        if (!enabled || to_other < to_wrap)
+        {
+            count(to_other);
+        }
+        else
+        {
+            count(to_wrap);
+        }
+    }
+
+    update();
+    wakeups++;
+}
+
+/* timers of the workload, each must run in its tick and in that tick of real time */
+typedef struct
+{
+    Timer timer;
+    uint32_t due;
+} Test_Timer;
+
+static Test_Timer probe;      // periodic, like the latency probe of the application
+static Test_Timer oneshot[4]; // started by the other interrupts, like the debouncer
+static uint32_t fired;
+static uint32_t wrong_tick;   // ran in another tick of the timer service
+static uint32_t wrong_time;   // ran outside of its tick of real time
+
+static void on_expiry(void *arg)
+{
+    Test_Timer *t = arg;
+    uint32_t tick = TIMER_Now() - 1U;
+
+    fired++;
+
+    if (tick != t->due) wrong_tick++;
+
+    /* the interrupt of tick n comes when the counter wraps at the end of it */
+    if (cycles / TICK_CYCLES != tick + 1ULL) wrong_time++;
+
+    t->due += t->timer.period;
+}
+
+static void start(Test_Timer *t, uint32_t delay, uint32_t period)
+{
+    t->due = TIMER_Now() + delay;
+    TIMER_Start(&t->timer, delay, period);
+}
+
+/* the systick handler of the application, without the latency and
+profiling hooks */
+static uint32_t systick_irqs;
+
+static void systick_handler(void)
+{
+    systick_irqs++;
+    SYSTICK_Inc_Ticks();
+    TIMER_Tick();
+}
+
+/* another interrupt (a button, a received frame) starts a one-shot timer */
+static uint32_t other_irqs;
+
+static void other_handler(void)
+{
+    Test_Timer *t = &oneshot[(uint32_t)rand() % 4U];
+
+    other_irqs++;
+
+    if (!TIMER_Is_Active(&t->timer))
+    {
+        start(t, 1U + (uint32_t)rand() % 200U, 0);
+    }
+}
+
+static void setup(uint32_t other_irq_interval)
+{
+    running = 0;
+    cycles = 0;
+    current = 0;
+    pending = 0;
+    lost_ticks = 0;
+    cvr_written = 0;
+    SYSTICK_Init(TICK_CYCLES * 1000U, SYSTICK_MS);
+    ticks = 0;
+    update();
+
+    memset(wheel, 0, sizeof(wheel));
+    expired = NULL;
+    wheel_time = 0;
+
+    TIMER_Init(&probe.timer, on_expiry, &probe, TIMER_RUN_IN_TICK);
+    start(&probe, 100, 100);
+
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        TIMER_Init(&oneshot[i].timer, on_expiry, &oneshot[i], TIMER_RUN_IN_TICK);
+    }
+
+    fired = 0;
+    wrong_tick = 0;
+    wrong_time = 0;
+    wakeups = 0;
+    systick_irqs = 0;
+    other_irqs = 0;
+
+    /* no other interrupts when the interval is 0 */
+    other_irq_at = other_irq_interval ? (uint64_t)other_irq_interval * TICK_CYCLES : UINT64_MAX;
+}
+
+/* the idle loop of the application for a number of simulated seconds,
+returns the systick interrupts per second */
+static uint32_t run(uint8_t tickless, uint32_t seconds, uint32_t other_irq_interval)
+{
+    setup(other_irq_interval);
+
+    while (cycles < seconds * SECOND)
+    {
+        /* Idle in main.c, called with interrupts disabled */
+        if (tickless)
+        {
+            running = 1;
+            uint32_t skipped = SYSTICK_Sleep(TIMER_Ticks_Until_Next());
+            running = 0;
+            update();
+            TIMER_Advance(skipped);
+        }
+        else
+        {
+            sim_wfi();
+        }
+
+        /* interrupts enabled again, the pending ones run */
+        if (pending)
+        {
+            pending = 0;
+            update();
+            systick_handler();
+        }
+
+        if (cycles >= other_irq_at)
+        {
+            other_handler();
+            other_irq_at = cycles + (1U + (uint32_t)rand() % (2U * other_irq_interval)) * (uint64_t)TICK_CYCLES / 2U;
+        }
+    }
+
+    /* the tick count kept up with the real time */
+    CHECK_EQ(lost_ticks, 0);
+    CHECK_EQ(SYSTICK_Get_Ticks(), cycles / TICK_CYCLES);
+    CHECK_EQ(TIMER_Now(), SYSTICK_Get_Ticks());
+    CHECK(fired >= 10U * seconds - 1U); // the probe every 100 ticks
+    CHECK_EQ(wrong_tick, 0);
+    CHECK_EQ(wrong_time, 0);
+
+    return systick_irqs / seconds;
+}
+
+/* systick interrupts per simulated second, idle with only the periodic
+timer and with other interrupts waking up the sleep early every 20 ms on
+average */
+static void test_wakeups(void)
+{
+    uint32_t plain = run(0, 2, 0);
+    uint32_t idle = run(1, 2, 0);
+    uint32_t plain_busy = run(0, 2, 20);
+    uint32_t busy = run(1, 2, 20);
+    uint32_t busy_wakeups = wakeups / 2U;
+
+    /* one interrupt per tick without tickless idle, and with it one per
+    wheel refill (every 64 ticks) and per expiring timer */
+    CHECK_EQ(plain, 1000);
+    CHECK_EQ(plain_busy, 1000);
+    CHECK(idle <= 1000U / 64U + 1U + 10U);
+    CHECK(busy < plain_busy / 4U);
+
+    printf("tickless: systick interrupts per second, idle: %u with TICKLESS_IDLE=0, %u with TICKLESS_IDLE=1, "
+           "other interrupts every 20 ms: %u and %u (%u wakeups)\n",
+           plain, idle, plain_busy, busy, busy_wakeups);
+}
+
+/* a sleep of 1 tick only waits for the next interrupt, and a sleep longer
+than the 24-bit counter allows is cut to what fits */
+static void test_limits(void)
+{
+    setup(0);
+    running = 1;
+    CHECK_EQ(SYSTICK_Sleep(1), 0);
+    running = 0;
+    CHECK(pending);
+    CHECK_EQ(cycles, TICK_CYCLES);
+
+    pending = 0;
+    update();
+    systick_handler();
+
+    running = 1;
+    uint32_t skipped = SYSTICK_Sleep(1000);
+    running = 0;
+    update();
+    CHECK_EQ(skipped, (SYSTICK_MAX_RELOAD + 1UL) / TICK_CYCLES - 1U);
+    CHECK(pending);
+    CHECK_EQ(SYSTICK_Get_Ticks() + 1U, cycles / TICK_CYCLES);
+}
+
+int main(void)
+{
+    uint8_t *page = trap_map(on_access);
+    systick = (SYSTICK_Peripheral *)page;
+    scb = (SCB_Peripheral *)(page + SCB_OFFSET);
+
+    srand(1);
+    test_limits();
+    test_wakeups();
+
+    return test_result("tickless");
+}
\ No newline at end of file
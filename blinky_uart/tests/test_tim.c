@@ -0,0 +1,161 @@
+#include "tests/test.h"
+
+#include "drivers/src/dma.c"
+#include "drivers/src/tim.c"
+
+#include <string.h>
+
+/* fake timer */
+static TIM_Peripheral tim;
+
+/* the period fits in 16 bits with a prescaler as small as possible, and
+the pwm frequency is as close as the clock allows */
+static void check_frequency(uint32_t clock, uint32_t freq)
+{
+    memset(&tim, 0, sizeof(tim));
+    TIM_PWM_Init(&tim, TIM_CHANNEL_1, clock, freq);
+
+    uint32_t cycles = clock / freq;
+    uint32_t period = TIM_PWM_Get_Period(&tim);
+    uint32_t steps = tim.PSC + 1U;
+
+    CHECK(period >= 1U && period <= TIM_MAX_PERIOD);
+    CHECK(tim.PSC <= 0xFFFFU);
+    CHECK(period * steps <= cycles);
+    CHECK(cycles - period * steps < steps);
+
+    /* one step less of prescaler would not fit */
+    if (tim.PSC > 0)
+    {
+        CHECK(cycles / tim.PSC > TIM_MAX_PERIOD);
+    }
+
+    /* a duty cycle of 100% keeps the output on the whole period, and the
+    compare value is still the same in a 16-bit register */
+    TIM_PWM_Set_Duty(&tim, TIM_CHANNEL_1, 1000);
+    CHECK_EQ(tim.CCR[0], period);
+    CHECK_EQ((uint16_t)tim.CCR[0], period);
+
+    TIM_PWM_Set_Duty(&tim, TIM_CHANNEL_1, 0);
+    CHECK_EQ(tim.CCR[0], 0);
+}
+
+static void test_frequencies(void)
+{
+    static const uint32_t clocks[] = { 16000000U, 90000000U, 65536000U, 180000000U };
+    static const uint32_t freqs[] = { 1, 2, 3, 7, 50, 200, 1000, 1001, 20000, 65535, 65536, 65537, 1000000 };
+
+    for (uint32_t c = 0; c < sizeof(clocks) / sizeof(clocks[0]); c++)
+    {
+        for (uint32_t f = 0; f < sizeof(freqs) / sizeof(freqs[0]); f++)
+        {
+            check_frequency(clocks[c], freqs[f]);
+        }
+
+        check_frequency(clocks[c], clocks[c]);
+        check_frequency(clocks[c], clocks[c] / 2U);
+    }
+
+    /* exactly 65536 cycles used to give ARR = 0xFFFF, a period of 0x10000 */
+    check_frequency(65536000U, 1000U);
+    CHECK_EQ(TIM_PWM_Get_Period(&tim), 32768);
+    CHECK_EQ(tim.PSC, 1);
+
+    /* 65535 cycles still fit with the prescaler at 1 */
+    check_frequency(65535000U, 1000U);
+    CHECK_EQ(TIM_PWM_Get_Period(&tim), 65535);
+    CHECK_EQ(tim.PSC, 0);
+}
+
+/* a frequency of 0 or above the clock leaves the timer alone */
+static void test_invalid(void)
+{
+    memset(&tim, 0, sizeof(tim));
+    tim.ARR = 999U;
+    tim.PSC = 5U;
+    tim.CCR[0] = 500U;
+
+    TIM_PWM_Init(&tim, TIM_CHANNEL_1, 16000000U, 0);
+    TIM_PWM_Init(&tim, TIM_CHANNEL_1, 16000000U, 16000001U);
+    TIM_PWM_Set_Frequency(&tim, 16000000U, 0);
+    TIM_PWM_Set_Frequency(&tim, 16000000U, 16000001U);
+
+    CHECK_EQ(tim.ARR, 999);
+    CHECK_EQ(tim.PSC, 5);
+    CHECK_EQ(tim.CCR[0], 500);
+    CHECK_EQ(tim.CR1, 0);
+
+    /* a 32-bit timer that was never set up, ARR + 1 wraps to 0 */
+    tim.ARR = 0xFFFFFFFFU;
+    TIM_PWM_Set_Frequency(&tim, 16000000U, 1000U);
+    CHECK_EQ(TIM_PWM_Get_Period(&tim), 16000);
+    CHECK_EQ(tim.CCR[0], 500);
+}
+
+/* the scaled compare value is rounded down, so it can be off by one step
+of the old period */
+static void check_near(uint32_t actual, uint32_t expected, uint32_t tolerance)
+{
+    CHECK(actual <= expected && expected - actual <= tolerance);
+}
+
+/* a new frequency keeps the duty cycle of every channel */
+static void test_keep_duty(void)
+{
+    memset(&tim, 0, sizeof(tim));
+    TIM_PWM_Init(&tim, TIM_CHANNEL_1, 90000000U, 200U);
+    TIM_PWM_Init(&tim, TIM_CHANNEL_3, 90000000U, 200U);
+    TIM_PWM_Set_Duty(&tim, TIM_CHANNEL_1, 250);
+    TIM_PWM_Set_Duty(&tim, TIM_CHANNEL_3, 1000);
+
+    TIM_PWM_Set_Frequency(&tim, 90000000U, 20000U);
+
+    uint32_t period = TIM_PWM_Get_Period(&tim);
+    CHECK_EQ(period, 4500);
+    check_near(tim.CCR[0], period / 4U, 1);
+    CHECK_EQ(tim.CCR[2], period);
+
+    /* the other way, from 4500 steps up to the 16-bit limit */
+    TIM_PWM_Set_Frequency(&tim, 65535000U, 1000U);
+    CHECK_EQ(TIM_PWM_Get_Period(&tim), 65535);
+    CHECK_EQ(tim.CCR[2], 65535);
+    check_near(tim.CCR[0], 65535U / 4U, 65535U / 4500U + 1U);
+}
+
+/* compare values loaded by dma, a word per update event */
+static void test_dma(void)
+{
+    static DMA_Peripheral dma;
+    static const uint32_t table[] = { 0, 100, 4500, 100 };
+
+    memset(&tim, 0, sizeof(tim));
+    memset(&dma, 0, sizeof(dma));
+    TIM_PWM_Init(&tim, TIM_CHANNEL_2, 90000000U, 20000U);
+    TIM_PWM_DMA_Start(&tim, TIM_CHANNEL_2, &dma, DMA_STREAM_1, DMA_CHANNEL_3, table, 4);
+
+    /* a half-word would land in both halves of the 32-bit ccr of tim2 and tim5 */
+    uint32_t cr = dma.STREAM[1].CR;
+    CHECK_EQ(cr & (DMA_CONFIG_PSIZE_16 | DMA_CONFIG_PSIZE_32), DMA_CONFIG_PSIZE_32);
+    CHECK_EQ(cr & (DMA_CONFIG_MSIZE_16 | DMA_CONFIG_MSIZE_32), DMA_CONFIG_MSIZE_32);
+    CHECK(cr & DMA_CONFIG_CIRCULAR);
+    CHECK(cr & DMA_CONFIG_MEM_INC);
+    CHECK(cr & BIT(0));
+    CHECK_EQ(dma.STREAM[1].PAR, (uint32_t)(uintptr_t)&tim.CCR[1]);
+    CHECK_EQ(dma.STREAM[1].M0AR, (uint32_t)(uintptr_t)table);
+    CHECK_EQ(dma.STREAM[1].NDTR, 4);
+    CHECK(tim.DIER & BIT(8));
+
+    TIM_PWM_DMA_Stop(&tim, &dma, DMA_STREAM_1);
+    CHECK(!(tim.DIER & BIT(8)));
+    CHECK(!(dma.STREAM[1].CR & BIT(0)));
+}
+
+int main(void)
+{
+    test_frequencies();
+    test_invalid();
+    test_keep_duty();
+    test_dma();
+
+    return test_result("tim");
+}
\ No newline at end of file
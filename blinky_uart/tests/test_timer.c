@@ -0,0 +1,297 @@
+#include "tests/test.h"
+
+#include "services/src/timer.c"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define TIMERS 600
+
+/* a timer under test and the tick it has to expire in next */
+typedef struct
+{
+    Timer timer;
+    uint32_t due;     // tick the callback must run in
+    uint32_t period;
+    uint32_t fired;   // number of times the callback ran
+    uint32_t late;    // number of times it ran in another tick
+    uint8_t rearm;    // start again with a new random delay from the callback
+    uint8_t stopped;  // stopped before it was due, must not run
+} Test_Timer;
+
+static Test_Timer timers[TIMERS];
+
+/* the tick being processed, TIMER_Now() is already one past it in a callback */
+static uint32_t current_tick(void)
+{
+    return TIMER_Now() - 1U;
+}
+
+/* a random delay on a random level of the wheel */
+static uint32_t random_delay(void)
+{
+    uint32_t level = (uint32_t)rand() % TIMER_WHEEL_LEVELS;
+    uint32_t low = (level == 0) ? 0U : 1UL << (TIMER_WHEEL_BITS * level);
+    uint32_t high = 1UL << (TIMER_WHEEL_BITS * (level + 1U));
+    uint32_t span = high - low;
+
+    return low + (uint32_t)(((uint64_t)(uint32_t)rand() << 16 ^ (uint32_t)rand()) % span);
+}
+
+static void start(Test_Timer *t, uint32_t delay, uint32_t period)
+{
+    t->due = TIMER_Now() + delay;
+    t->period = period;
+    TIMER_Start(&t->timer, delay, period);
+}
+
+static void on_expiry(void *arg)
+{
+    Test_Timer *t = arg;
+
+    t->fired++;
+
+    if (t->stopped || current_tick() != t->due)
+    {
+        t->late++;
+    }
+
+    if (t->period != 0)
+    {
+        t->due += t->period;
+    }
+    else if (t->rearm)
+    {
+        t->rearm--;
+        start(t, random_delay() >> 6, 0);
+    }
+}
+
+/* reset the wheel to an empty state at a given time */
+static void reset(uint32_t now)
+{
+    memset(wheel, 0, sizeof(wheel));
+    expired = NULL;
+    deferred_head = NULL;
+    deferred_tail = NULL;
+    wheel_time = now;
+    memset(timers, 0, sizeof(timers));
+}
+
+/* hundreds of one-shot, re-armed, periodic and stopped timers at random
+delays on every level, each one must expire in exactly its tick */
+static void run_random(uint32_t now)
+{
+    reset(now);
+    srand(now + 1U);
+
+    for (uint32_t i = 0; i < TIMERS; i++)
+    {
+        Test_Timer *t = &timers[i];
+        TIMER_Init(&t->timer, on_expiry, t, TIMER_RUN_IN_TICK);
+
+        switch (i % 4)
+        {
+            case 0:
+                start(t, random_delay(), 0);
+                break;
+            case 1:
+                t->rearm = 3;
+                start(t, random_delay() >> 6, 0); // keep the chains within the run
+                break;
+            case 2:
+                start(t, random_delay() >> 8, 1U + (uint32_t)rand() % 5000U);
+                break;
+            default:
+                start(t, 1U + random_delay(), 0);
+                break;
+        }
+    }
+
+    /* longest first delay is below 2^24, the run covers it and the re-armed chains */
+    uint32_t end = now + (1UL << 24) + (1UL << 20);
+    uint32_t stop_at = now + 4096U;
+
+    while (wheel_time != end)
+    {
+        if (wheel_time == stop_at)
+        {
+            /* stop the timers of the last group that have not expired yet */
+            for (uint32_t i = 3; i < TIMERS; i += 4)
+            {
+                if (TIMER_Is_Active(&timers[i].timer))
+                {
+                    timers[i].stopped = 1;
+                    TIMER_Stop(&timers[i].timer);
+                }
+            }
+        }
+
+        TIMER_Tick();
+    }
+
+    for (uint32_t i = 0; i < TIMERS; i++)
+    {
+        Test_Timer *t = &timers[i];
+
+        CHECK_EQ(t->late, 0);
+
+        switch (i % 4)
+        {
+            case 0:
+                CHECK_EQ(t->fired, 1);
+                break;
+            case 1:
+                CHECK_EQ(t->fired, 4);
+                break;
+            case 2:
+                /* every period until the end, the next expiry is still pending */
+                CHECK(t->fired > 0);
+                CHECK(t->due - wheel_time <= t->period);
+                TIMER_Stop(&t->timer);
+                break;
+            default:
+                CHECK_EQ(t->fired, t->stopped ? 0U : 1U);
+                break;
+        }
+    }
+}
+
+static void test_random(void)
+{
+    run_random(0);
+
+    /* the tick count wraps during the run */
+    run_random(0xFFFFFFFFU - 5000000U);
+}
+
+/* start and stop from a callback, a callback may stop timers that expire in the same tick */
+static Timer chain_a;
+static Timer chain_b;
+static uint32_t chain_b_runs;
+
+static void stop_b(void *arg)
+{
+    (void)arg;
+    TIMER_Stop(&chain_b);
+}
+
+static void count_b(void *arg)
+{
+    (void)arg;
+    chain_b_runs++;
+}
+
+static void test_same_tick(void)
+{
+    reset(100);
+
+    TIMER_Init(&chain_a, stop_b, NULL, TIMER_RUN_IN_TICK);
+    TIMER_Init(&chain_b, count_b, NULL, TIMER_RUN_IN_TICK);
+
+    /* b is started first so a runs first (slots are lifo) and stops it */
+    TIMER_Start(&chain_b, 10, 0);
+    TIMER_Start(&chain_a, 10, 0);
+    TIMER_Advance(20);
+
+    CHECK_EQ(chain_b_runs, 0);
+    CHECK(!TIMER_Is_Active(&chain_a));
+    CHECK(!TIMER_Is_Active(&chain_b));
+}
+
+/* ticks until the next tick with expiring timers or a refill of level 0 */
+static void test_until_next(void)
+{
+    reset(0);
+
+    static Timer timer;
+    TIMER_Init(&timer, NULL, NULL, TIMER_RUN_IN_TICK);
+
+    CHECK_EQ(TIMER_Ticks_Until_Next(), 1); // refill at tick 0
+    TIMER_Tick();
+    CHECK_EQ(TIMER_Ticks_Until_Next(), 64);
+
+    TIMER_Start(&timer, 9, 0);
+    CHECK_EQ(TIMER_Ticks_Until_Next(), 10);
+    TIMER_Advance(9);
+    CHECK_EQ(TIMER_Ticks_Until_Next(), 1);
+    TIMER_Tick();
+    CHECK(!TIMER_Is_Active(&timer));
+    CHECK_EQ(TIMER_Ticks_Until_Next(), 54);
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+}
+
+static void nothing(void *arg)
+{
+    (void)arg;
+}
+
+/* cost of the most expensive ticks: every timer expiring in the same
+tick, and every timer moved down from one slot of the highest level
+through all the levels below (the tick at a multiple of 64^3) */
+/* host timings, only the relation between the numbers carries over to the target */
+static void bench_tick(void)
+{
+    uint64_t start_ns;
+
+    reset(0);
+    for (uint32_t i = 0; i < TIMERS; i++)
+    {
+        TIMER_Init(&timers[i].timer, nothing, NULL, TIMER_RUN_IN_TICK);
+    }
+
+    TIMER_Advance(1);
+    start_ns = now_ns();
+    for (uint32_t i = 0; i < 1000; i++) TIMER_Tick();
+    uint64_t empty = (now_ns() - start_ns) / 1000U;
+
+    reset(1);
+    for (uint32_t i = 0; i < TIMERS; i++)
+    {
+        TIMER_Init(&timers[i].timer, nothing, NULL, TIMER_RUN_IN_TICK);
+        TIMER_Start(&timers[i].timer, 10, 0);
+    }
+    TIMER_Advance(10);
+    start_ns = now_ns();
+    TIMER_Tick();
+    uint64_t expire = now_ns() - start_ns;
+    CHECK(!TIMER_Is_Active(&timers[0].timer));
+
+    /* all of them in one level 3 slot, 64^3 + 5 ticks away */
+    uint32_t level3 = 1UL << (3U * TIMER_WHEEL_BITS);
+    reset(1);
+    for (uint32_t i = 0; i < TIMERS; i++)
+    {
+        TIMER_Init(&timers[i].timer, nothing, NULL, TIMER_RUN_IN_TICK);
+        TIMER_Start(&timers[i].timer, level3 + 4U, 0);
+    }
+    TIMER_Advance(level3 - 1U);
+    CHECK_EQ(TIMER_Now(), level3);
+    start_ns = now_ns();
+    TIMER_Tick();
+    uint64_t cascade = now_ns() - start_ns;
+    CHECK(TIMER_Is_Active(&timers[0].timer));
+    TIMER_Advance(5);
+    CHECK(!TIMER_Is_Active(&timers[0].timer));
+
+    printf("timer: empty tick %llu ns, %u timers expiring %llu ns, %u timers cascading %llu ns\n",
+           (unsigned long long)empty, TIMERS, (unsigned long long)expire,
+           TIMERS, (unsigned long long)cascade);
+}
+
+int main(void)
+{
+    test_random();
+    test_same_tick();
+    test_until_next();
+    bench_tick();
+
+    return test_result("timer");
+}
\ No newline at end of file
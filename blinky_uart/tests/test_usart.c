@@ -0,0 +1,467 @@
+/* for tests/trap.h */
+#define _GNU_SOURCE
+
+#include "tests/test.h"
+#include "tests/trap.h"
+
+#include "drivers/src/dma.c"
+#include "drivers/src/usart.c"
+
+#include <string.h>
+
+/* fake usart, the status register is set by the tests to simulate the
+hardware and DR holds the last byte written by the driver */
+static USART_Peripheral usart;
+
+/* value left in DR to tell whether the handler wrote a byte */
+#define DR_EMPTY 0x100U
+
+/* simulate the txe interrupt until the driver disables it, the transmit
+data register is empty every time so one byte is sent per interrupt */
+/* returns the number of bytes sent, or more than max if the interrupt never stopped */
+static size_t run_tx(char *out, size_t max)
+{
+    size_t sent = 0;
+
+    usart.SR = BIT(7);
+
+    for (size_t irqs = 0; usart.CR1 & BIT(7); irqs++)
+    {
+        if (irqs > max + 1U) return max + 1U;
+
+        usart.DR = DR_EMPTY;
+        USART_IRQ_Handler(&usart);
+
+        if (usart.DR != DR_EMPTY)
+        {
+            if (sent < max)
+            {
+                out[sent] = (char)usart.DR;
+            }
+            sent++;
+        }
+    }
+
+    return sent;
+}
+
+static void setup(void)
+{
+    memset(&usart, 0, sizeof(usart));
+    USART_Init(&usart, 16000000U, 9600U);
+}
+
+/* a queued buffer is sent byte by byte and txeie is cleared once the ring is empty */
+static void test_tx_bytes(void)
+{
+    setup();
+
+    CHECK(!(usart.CR1 & BIT(7)));
+    CHECK_EQ(USART_Transmit_Async(&usart, "hello", 5), 5);
+    CHECK(usart.CR1 & BIT(7));
+    CHECK_EQ(USART_Tx_Space(&usart), USART_TX_BUFFER_SIZE - 5U);
+
+    char out[16];
+    CHECK_EQ(run_tx(out, sizeof(out)), 5);
+    CHECK(memcmp(out, "hello", 5) == 0);
+    CHECK(!(usart.CR1 & BIT(7)));
+    CHECK_EQ(USART_Tx_Space(&usart), USART_TX_BUFFER_SIZE);
+
+    /* a txe interrupt with an empty ring only disables itself */
+    usart.CR1 |= BIT(7);
+    CHECK_EQ(run_tx(out, sizeof(out)), 0);
+}
+
+/* a buffer larger than the free space is queued partially */
+static void test_tx_partial(void)
+{
+    setup();
+
+    char in[USART_TX_BUFFER_SIZE + 44U];
+    for (size_t i = 0; i < sizeof(in); i++)
+    {
+        in[i] = (char)(i * 7U);
+    }
+
+    CHECK_EQ(USART_Transmit_Async(&usart, in, sizeof(in)), USART_TX_BUFFER_SIZE);
+    CHECK_EQ(USART_Transmit_Async(&usart, in, 1), 0);
+    CHECK_EQ(USART_Tx_Space(&usart), 0);
+
+    char out[USART_TX_BUFFER_SIZE];
+    CHECK_EQ(run_tx(out, sizeof(out)), USART_TX_BUFFER_SIZE);
+    CHECK(memcmp(out, in, USART_TX_BUFFER_SIZE) == 0);
+    CHECK(!(usart.CR1 & BIT(7)));
+}
+
+/* bytes queued across the end of the ring buffer come out in order,
+also when the free-running counters overflow */
+static void test_tx_wrap(void)
+{
+    static const uint32_t starts[] = { 0U, 0xFFFFFF80U };
+
+    for (size_t s = 0; s < sizeof(starts) / sizeof(starts[0]); s++)
+    {
+        setup();
+        states[0].tx.head = starts[s];
+        states[0].tx.tail = starts[s];
+
+        for (uint32_t round = 0; round < 5; round++)
+        {
+            char in[200];
+            for (size_t i = 0; i < sizeof(in); i++)
+            {
+                in[i] = (char)(round * 31U + i);
+            }
+
+            CHECK_EQ(USART_Transmit_Async(&usart, in, 120), 120);
+            CHECK_EQ(USART_Transmit_Async(&usart, &in[120], 80), 80);
+
+            char out[200];
+            CHECK_EQ(run_tx(out, sizeof(out)), sizeof(in));
+            CHECK(memcmp(out, in, sizeof(in)) == 0);
+        }
+    }
+}
+
+/* the async api does nothing for a usart that was never initialized */
+static void test_tx_uninitialized(void)
+{
+    USART_Peripheral other = { 0 };
+
+    CHECK_EQ(USART_Transmit_Async(&other, "x", 1), 0);
+    CHECK_EQ(USART_Tx_Space(&other), 0);
+    CHECK(!(other.CR1 & BIT(7)));
+}
+
+/* fake dma controller for the dma transmit path */
+static DMA_Peripheral dma;
+static uint32_t dma_done_calls;
+
+static void dma_done(void)
+{
+    dma_done_calls++;
+}
+
+/* the dma and the ring buffer never drive the data register at the same time */
+static void test_dma_tx_arbitration(void)
+{
+    setup();
+    memset(&dma, 0, sizeof(dma));
+    dma_done_calls = 0;
+    USART_DMA_Init(&usart, &dma, DMA_STREAM_6, DMA_STREAM_5, DMA_CHANNEL_4);
+
+    CHECK(USART_DMA_Tx_Ready(&usart));
+    CHECK_EQ(USART_DMA_Transmit(&usart, "abc", 3, dma_done), 3);
+    CHECK_EQ(dma.STREAM[DMA_STREAM_6].NDTR, 3);
+    CHECK(dma.STREAM[DMA_STREAM_6].CR & BIT(0));
+    CHECK(usart.CR3 & BIT(7));
+
+    /* a second dma transmit is refused while the first one runs */
+    CHECK(!USART_DMA_Tx_Ready(&usart));
+    CHECK_EQ(USART_DMA_Transmit(&usart, "def", 3, dma_done), 0);
+
+    /* ring buffer bytes are queued but wait for the dma */
+    CHECK_EQ(USART_Transmit_Async(&usart, "xy", 2), 2);
+    CHECK(!(usart.CR1 & BIT(7)));
+
+    /* transfer complete: the ring buffer takes over */
+    dma_tx_event(DMA_FLAG_TC, &states[0]);
+    CHECK_EQ(dma_done_calls, 1);
+    CHECK(!(usart.CR3 & BIT(7)));
+    CHECK(usart.CR1 & BIT(7));
+
+    /* and a dma transmit waits until the ring buffer is empty */
+    CHECK(!USART_DMA_Tx_Ready(&usart));
+    CHECK_EQ(USART_DMA_Transmit(&usart, "def", 3, dma_done), 0);
+
+    char out[8];
+    CHECK_EQ(run_tx(out, sizeof(out)), 2);
+    CHECK(memcmp(out, "xy", 2) == 0);
+    CHECK(USART_DMA_Tx_Ready(&usart));
+}
+
+/* receive side */
+/* the receive tests need the status flags to behave like the hardware:
+reading SR and then DR clears the error and idle flags, and reading DR
+clears RXNE. so this fake usart is a trapped page, see tests/trap.h */
+#define SR_PE   BIT(0)
+#define SR_FE   BIT(1)
+#define SR_NF   BIT(2)
+#define SR_ORE  BIT(3)
+#define SR_IDLE BIT(4)
+#define SR_RXNE BIT(5)
+
+static USART_Peripheral *rx_usart;
+static volatile int in_driver; // accesses only have side effects while the driver runs
+static int sr_was_read;
+
+/* clear the flags the way the hardware does on a read by the driver */
+static void on_access(uintptr_t offset, uint8_t write)
+{
+    if (!in_driver || write) return;
+
+    if (offset == offsetof(USART_Peripheral, SR))
+    {
+        sr_was_read = 1;
+    }
+    else if (offset == offsetof(USART_Peripheral, DR))
+    {
+        if (sr_was_read)
+        {
+            rx_usart->SR &= ~(SR_PE | SR_FE | SR_NF | SR_ORE | SR_IDLE);
+        }
+        rx_usart->SR &= ~SR_RXNE;
+        sr_was_read = 0;
+    }
+}
+
+static void rx_irq(void)
+{
+    in_driver = 1;
+    USART_IRQ_Handler(rx_usart);
+    in_driver = 0;
+}
+
+static size_t rx_read(char *buf, size_t len)
+{
+    in_driver = 1;
+    size_t read = USART_Read_Frame(rx_usart, buf, len);
+    in_driver = 0;
+
+    return read;
+}
+
+/* a byte arrives, the hardware reports an overrun if the last one was not read yet */
+static void rx_arrive(char byte)
+{
+    if (rx_usart->SR & SR_RXNE)
+    {
+        rx_usart->SR |= SR_ORE; // the new byte is lost
+        return;
+    }
+
+    rx_usart->DR = (uint8_t)byte;
+    rx_usart->SR |= SR_RXNE;
+}
+
+/* a byte arrives and its interrupt runs */
+static void rx_byte(char byte)
+{
+    rx_arrive(byte);
+    rx_irq();
+}
+
+/* the line goes idle */
+static void rx_idle(void)
+{
+    rx_usart->SR |= SR_IDLE;
+    rx_irq();
+}
+
+static void rx_setup(void)
+{
+    in_driver = 0;
+    memset(rx_usart, 0, sizeof(*rx_usart));
+    in_driver = 1;
+    USART_Init(rx_usart, 16000000U, 9600U);
+    in_driver = 0;
+}
+
+static USART_Error_Counts rx_errors(void)
+{
+    USART_Error_Counts errors;
+    USART_Get_Errors(rx_usart, &errors);
+    return errors;
+}
+
+/* frames end where the line goes idle */
+static void test_rx_frames(void)
+{
+    rx_setup();
+
+    const char *text = "abc";
+    for (size_t i = 0; i < 3; i++) rx_byte(text[i]);
+    CHECK(!(rx_usart->SR & SR_RXNE));
+    CHECK(!USART_Frame_Available(rx_usart));
+    rx_idle();
+    CHECK(!(rx_usart->SR & SR_IDLE));
+    rx_byte('d');
+    rx_byte('e');
+    rx_idle();
+
+    /* idle without new bytes does not end an empty frame */
+    rx_idle();
+
+    char buf[16];
+    CHECK_EQ(rx_read(buf, sizeof(buf)), 3);
+    CHECK(memcmp(buf, "abc", 3) == 0);
+    CHECK_EQ(rx_read(buf, sizeof(buf)), 2);
+    CHECK(memcmp(buf, "de", 2) == 0);
+    CHECK_EQ(rx_read(buf, sizeof(buf)), 0);
+
+    /* a frame longer than the buffer is cut off and the rest is discarded */
+    for (size_t i = 0; i < 10; i++) rx_byte((char)('0' + i));
+    rx_idle();
+    rx_byte('x');
+    rx_idle();
+    CHECK_EQ(rx_read(buf, 4), 4);
+    CHECK(memcmp(buf, "0123", 4) == 0);
+    CHECK_EQ(rx_read(buf, sizeof(buf)), 1);
+    CHECK_EQ(buf[0], 'x');
+}
+
+/* bytes arriving back to back, every byte as soon as the last one was
+read by the interrupt, are never lost while fewer than
+USART_RX_BUFFER_SIZE are waiting */
+static void test_rx_stress(void)
+{
+    rx_setup();
+    srand(1);
+
+    static char sent[20000];
+    static char received[20000];
+    size_t sent_len = 0;
+    size_t received_len = 0;
+    uint32_t waiting = 0; // bytes received but not read
+    uint32_t frames = 0;  // frames not read
+
+    while (sent_len < sizeof(sent) - USART_RX_BUFFER_SIZE)
+    {
+        /* a frame that still fits into the ring buffer and the frame slots */
+        uint32_t len = 1U + (uint32_t)rand() % 64U;
+
+        if (waiting + len <= USART_RX_BUFFER_SIZE && frames < USART_RX_MAX_FRAMES)
+        {
+            for (uint32_t i = 0; i < len; i++)
+            {
+                char byte = (char)rand();
+                sent[sent_len++] = byte;
+                rx_byte(byte);
+            }
+            rx_idle();
+            waiting += len;
+            frames++;
+        }
+
+        /* the reader runs at random times */
+        if (frames > 0 && (rand() % 3 == 0 || waiting + 64U > USART_RX_BUFFER_SIZE || frames == USART_RX_MAX_FRAMES))
+        {
+            size_t read = rx_read(&received[received_len], 64);
+            received_len += read;
+            waiting -= (uint32_t)read;
+            frames--;
+        }
+    }
+
+    size_t read;
+    while ((read = rx_read(&received[received_len], 64)) != 0)
+    {
+        received_len += read;
+    }
+
+    CHECK_EQ(received_len, sent_len);
+    CHECK(memcmp(sent, received, sent_len) == 0);
+
+    USART_Error_Counts errors = rx_errors();
+    CHECK_EQ(errors.dropped, 0);
+    CHECK_EQ(errors.overrun, 0);
+}
+
+/* a full ring buffer drops bytes and counts them */
+static void test_rx_ring_full(void)
+{
+    rx_setup();
+
+    for (uint32_t i = 0; i < USART_RX_BUFFER_SIZE + 3U; i++) rx_byte((char)i);
+    rx_idle();
+
+    CHECK_EQ(rx_errors().dropped, 3);
+
+    static char buf[USART_RX_BUFFER_SIZE];
+    CHECK_EQ(rx_read(buf, sizeof(buf)), USART_RX_BUFFER_SIZE);
+    CHECK_EQ((uint8_t)buf[USART_RX_BUFFER_SIZE - 1U], (uint8_t)(USART_RX_BUFFER_SIZE - 1U));
+}
+
+/* with every frame slot taken, the bytes of a new frame are kept and
+become part of the next frame once a slot is free */
+static void test_rx_frame_slots(void)
+{
+    rx_setup();
+
+    for (uint32_t i = 0; i < USART_RX_MAX_FRAMES + 1U; i++)
+    {
+        rx_byte((char)('a' + i));
+        rx_idle();
+    }
+
+    char buf[8];
+    CHECK_EQ(rx_read(buf, sizeof(buf)), 1);
+    CHECK_EQ(buf[0], 'a');
+
+    rx_byte('z');
+    rx_idle();
+
+    for (uint32_t i = 1; i < USART_RX_MAX_FRAMES; i++)
+    {
+        CHECK_EQ(rx_read(buf, sizeof(buf)), 1);
+        CHECK_EQ(buf[0], (char)('a' + i));
+    }
+
+    CHECK_EQ(rx_read(buf, sizeof(buf)), 2);
+    CHECK(memcmp(buf, "qz", 2) == 0);
+    CHECK_EQ(rx_read(buf, sizeof(buf)), 0);
+    CHECK_EQ(rx_errors().dropped, 0);
+}
+
+/* receive errors are counted and their flags cleared */
+static void test_rx_errors(void)
+{
+    rx_setup();
+
+    /* the second byte arrives before the interrupt read the first one */
+    rx_arrive('a');
+    rx_arrive('b');
+    CHECK(rx_usart->SR & SR_ORE);
+    rx_irq();
+    CHECK(!(rx_usart->SR & (SR_ORE | SR_RXNE)));
+    CHECK_EQ(rx_errors().overrun, 1);
+
+    /* a byte with a framing error and noise is still stored */
+    rx_arrive('c');
+    rx_usart->SR |= SR_FE | SR_NF;
+    rx_irq();
+    CHECK(!(rx_usart->SR & (SR_FE | SR_NF)));
+
+    /* an error flag without a byte is cleared too */
+    rx_usart->SR |= SR_ORE;
+    rx_irq();
+    CHECK(!(rx_usart->SR & SR_ORE));
+
+    USART_Error_Counts errors = rx_errors();
+    CHECK_EQ(errors.overrun, 2);
+    CHECK_EQ(errors.framing, 1);
+    CHECK_EQ(errors.noise, 1);
+
+    rx_idle();
+    char buf[8];
+    CHECK_EQ(rx_read(buf, sizeof(buf)), 2);
+    CHECK(memcmp(buf, "ac", 2) == 0);
+}
+
+int main(void)
+{
+    test_tx_bytes();
+    test_tx_partial();
+    test_tx_wrap();
+    test_tx_uninitialized();
+    test_dma_tx_arbitration();
+
+    rx_usart = trap_map(on_access);
+    test_rx_frames();
+    test_rx_stress();
+    test_rx_ring_full();
+    test_rx_frame_slots();
+    test_rx_errors();
+
+    return test_result("usart");
+}
\ No newline at end of file
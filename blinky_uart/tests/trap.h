@@ -0,0 +1,74 @@
+#ifndef TRAP_H_
+#define TRAP_H_
+
+/* register access traps for fake peripherals */
+/* plain memory cannot see reads, but some registers change when they are
+read (status flags cleared by a read, a counter that keeps counting). a
+fake peripheral that needs this lives in a page without access rights
+mapped by trap_map. every access to it faults, the fault handler calls
+the test's handler with the offset of the access before it happens, then
+opens the page and single-steps the access, and the trap after the step
+closes the page again. the handler runs between two instructions of the
+code under test, just like an interrupt would. x86-64 linux only, the
+test must define _GNU_SOURCE before its first include */
+
+#include <signal.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+/* called before every access to the trapped page, the page is accessible
+while it runs */
+typedef void (*Trap_Handler)(uintptr_t offset, uint8_t write);
+
+static void *trap_page;
+static size_t trap_page_size;
+static Trap_Handler trap_handler;
+
+static void trap_fault(int sig, siginfo_t *info, void *context)
+{
+    (void)sig;
+    ucontext_t *uc = context;
+    uintptr_t offset = (uintptr_t)info->si_addr - (uintptr_t)trap_page;
+
+    if (offset >= trap_page_size) abort(); // a real crash
+
+    mprotect(trap_page, trap_page_size, PROT_READ | PROT_WRITE);
+
+    trap_handler(offset, (uc->uc_mcontext.gregs[REG_ERR] & 2) != 0);
+
+    uc->uc_mcontext.gregs[REG_EFL] |= 0x100; // trap flag, step over the access
+}
+
+static void trap_step(int sig, siginfo_t *info, void *context)
+{
+    (void)sig;
+    (void)info;
+    ucontext_t *uc = context;
+
+    mprotect(trap_page, trap_page_size, PROT_NONE);
+    uc->uc_mcontext.gregs[REG_EFL] &= ~0x100;
+}
+
+/* map the trapped page, returns its address */
+static inline void *trap_map(Trap_Handler handler)
+{
+    trap_handler = handler;
+    trap_page_size = (size_t)sysconf(_SC_PAGESIZE);
+    trap_page = mmap(NULL, trap_page_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (trap_page == MAP_FAILED) abort();
+
+    struct sigaction action = { 0 };
+    action.sa_flags = SA_SIGINFO;
+    action.sa_sigaction = trap_fault;
+    sigaction(SIGSEGV, &action, NULL);
+    action.sa_sigaction = trap_step;
+    sigaction(SIGTRAP, &action, NULL);
+
+    return trap_page;
+}
+
+#endif // TRAP_H_
\ No newline at end of file
@@ -0,0 +1,48 @@
+"""Minimal ELF section header reader used by the build tools (no dependencies)."""
+
+import struct
+
+SHT_NOBITS = 8
+
+
+class Section:
+    def __init__(self, name, type_, addr, offset, size):
+        self.name = name
+        self.type = type_
+        self.addr = addr
+        self.offset = offset
+        self.size = size
+
+
+def read_sections(path):
+    """return a dict of section name -> Section for a 32 or 64-bit little endian elf file"""
+    with open(path, "rb") as f:
+        data = f.read()
+
+    if data[:4] != b"\x7fELF":
+        raise ValueError("%s is not an elf file" % path)
+
+    is64 = data[4] == 2
+    if is64:
+        shoff, = struct.unpack_from("<Q", data, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 0x3A)
+        fmt = "<IIQQQQ"
+    else:
+        shoff, = struct.unpack_from("<I", data, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 0x2E)
+        fmt = "<IIIIII"
+
+    headers = []
+    for i in range(shnum):
+        name, type_, flags, addr, offset, size = struct.unpack_from(fmt, data, shoff + i * shentsize)
+        headers.append((name, type_, addr, offset, size))
+
+    strtab = headers[shstrndx]
+    sections = {}
+    for name, type_, addr, offset, size in headers:
+        start = strtab[3] + name
+        end = data.index(b"\0", start)
+        section_name = data[start:end].decode()
+        sections[section_name] = Section(section_name, type_, addr, offset, size)
+
+    return sections, data
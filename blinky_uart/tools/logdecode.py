@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""Decode the binary log records sent by services/src/log.c.
+
+usage: logdecode.py firmware.elf [capture]
+
+Reads the usart byte stream from a capture file, or from stdin if no file
+is given, e.g. "stty -F /dev/ttyACM0 9600 raw && logdecode.py firmware.elf
+/dev/ttyACM0". The format strings are taken from the .logstr section of
+the elf file, which must be the one running on the board. A record is
+LOG_SYNC (0xA5), the offset of its string in .logstr (16 bits), the
+number of arguments and each argument as 32 bits, all little endian.
+Every other byte is text sent on the same usart and is printed as it is.
+"""
+
+import re
+import struct
+import sys
+
+import elf
+
+LOG_SYNC = 0xA5
+LOG_HEADER_SIZE = 4
+LOG_MAX_ARGS = 4
+
+# printf conversion: flags, width, precision, length modifier and conversion
+CONVERSION = re.compile(r"%([-+ #0]*\d*(?:\.\d+)?)(?:hh|h|l|ll|z)?([diuxXoc%])")
+
+
+def read_strings(path):
+    """return the .logstr section of an elf file as bytes"""
+    sections, data = elf.read_sections(path)
+    if ".logstr" not in sections:
+        raise ValueError("%s has no .logstr section" % path)
+    section = sections[".logstr"]
+    return data[section.offset:section.offset + section.size]
+
+
+def string_at(strings, offset):
+    """return the format string starting at an offset of .logstr, or None"""
+    if offset >= len(strings):
+        return None
+    end = strings.find(b"\0", offset)
+    if end < 0:
+        return None
+    return strings[offset:end].decode(errors="replace")
+
+
+def format_record(fmt, args):
+    """format a record like printf would, arguments are 32-bit integers"""
+    args = list(args)
+
+    def convert(match):
+        spec, conversion = match.group(1), match.group(2)
+        if conversion == "%":
+            return "%"
+        if not args:
+            return "<missing>"
+        value = args.pop(0)
+        if conversion in "di" and value & 0x80000000:
+            value -= 1 << 32
+        if conversion == "c":
+            return chr(value & 0xFF)
+        if conversion == "u":
+            conversion = "d"
+        return ("%" + spec + conversion) % value
+
+    return CONVERSION.sub(convert, fmt)
+
+
+def decode(stream, strings, out):
+    """decode a byte stream, records are written one per line"""
+    buf = b""
+    while True:
+        chunk = stream.read(1)
+        if not chunk:
+            break
+        buf += chunk
+
+        while buf:
+            if buf[0] != LOG_SYNC:
+                out.write(buf[:1].decode("latin-1"))
+                buf = buf[1:]
+                continue
+            if len(buf) < LOG_HEADER_SIZE:
+                break
+            offset, nargs = struct.unpack_from("<HB", buf, 1)
+            fmt = string_at(strings, offset)
+            if nargs > LOG_MAX_ARGS or fmt is None:
+                # not a record, the sync byte was lost or corrupted
+                out.write("<bad record>\n")
+                buf = buf[1:]
+                continue
+            size = LOG_HEADER_SIZE + 4 * nargs
+            if len(buf) < size:
+                break
+            args = struct.unpack_from("<%dI" % nargs, buf, LOG_HEADER_SIZE)
+            out.write(format_record(fmt, args) + "\n")
+            buf = buf[size:]
+        out.flush()
+
+
+def main(argv):
+    if len(argv) not in (2, 3):
+        print(__doc__.strip(), file=sys.stderr)
+        return 2
+
+    strings = read_strings(argv[1])
+
+    if len(argv) == 3:
+        with open(argv[2], "rb", buffering=0) as stream:
+            decode(stream, strings, sys.stdout)
+    else:
+        decode(sys.stdin.buffer, strings, sys.stdout)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+"""Report memory usage from a GNU ld map file.
+
+usage: memreport.py firmware.elf.map [region=size ...]
+
+Prints the used size of every memory region, of every output section and
+of every object file (per region), and compares each region against a
+budget. The elf file next to the map (the map name without ".map") is used,
+if it exists, to tell which sections actually occupy their load region.
+Budgets default to the region lengths declared in link.ld and can be
+overridden on the command line, e.g. "flash=256K sram1=64K". Exits with
+status 1 if any region is over budget, 2 on a budget for an unknown region.
+"""
+
+import os
+import re
+import sys
+
+import elf
+
+HEX = r"0x[0-9a-fA-F]+"
+# output section: ".name  0xaddr  0xsize [load address 0xaddr]", the name can be on its own line
+OUTPUT_SECTION = re.compile(r"^(\.\S+)(?:\s+(" + HEX + r")\s+(" + HEX + r")(?:\s+load address\s+(" + HEX + r"))?)?\s*$")
+ADDR_SIZE = re.compile(r"^\s+(" + HEX + r")\s+(" + HEX + r")(?:\s+load address\s+(" + HEX + r"))?(?:\s+(\S.*))?$")
+# input section: " .name  0xaddr  0xsize  object", the name can be on its own line
+INPUT_SECTION = re.compile(r"^ ((?:\.|COMMON)\S*|\*fill\*)(?:\s+(" + HEX + r")\s+(" + HEX + r")(?:\s+(\S.*))?)?\s*$")
+
+
+def parse_size(text):
+    """parse a size such as 512K, 1M or 0x1000"""
+    text = text.strip()
+    multiplier = 1
+    if text[-1] in "kK":
+        multiplier, text = 1024, text[:-1]
+    elif text[-1] in "mM":
+        multiplier, text = 1024 * 1024, text[:-1]
+    return int(text, 0) * multiplier
+
+
+def parse_map(path):
+    with open(path) as f:
+        lines = f.read().splitlines()
+
+    regions = {}  # name -> (origin, length)
+    sections = []  # (name, vma, size, lma)
+    objects = {}  # (object, output section, vma, lma) -> size, resolved to regions later
+
+    i = 0
+    while i < len(lines) and not lines[i].startswith("Memory Configuration"):
+        i += 1
+    i += 1
+    while i < len(lines) and not lines[i].startswith("Linker script and memory map"):
+        fields = lines[i].split()
+        if len(fields) >= 3 and fields[1].startswith("0x") and fields[0] != "*default*":
+            regions[fields[0]] = (int(fields[1], 16), int(fields[2], 16))
+        i += 1
+
+    current = None  # (vma, lma) offset of the current output section
+    pending_output = None
+    pending_input = None
+    for line in lines[i:]:
+        if pending_output is not None:
+            m = ADDR_SIZE.match(line)
+            if m:
+                line = pending_output + " " + line.strip()
+            pending_output = None
+        if pending_input is not None:
+            m = ADDR_SIZE.match(line)
+            if m:
+                line = " " + pending_input + " " + line.strip()
+            pending_input = None
+
+        m = OUTPUT_SECTION.match(line)
+        if m:
+            name, vma, size, lma = m.groups()
+            if vma is None:
+                pending_output = name
+                continue
+            vma, size = int(vma, 16), int(size, 16)
+            lma = int(lma, 16) if lma else vma
+            current = (name, vma, lma)
+            if size:
+                sections.append((name, vma, size, lma))
+            continue
+
+        m = INPUT_SECTION.match(line)
+        if m and current is not None:
+            name, addr, size, obj = m.groups()
+            if addr is None:
+                pending_input = name
+                continue
+            addr, size = int(addr, 16), int(size, 16)
+            if size == 0:
+                continue
+            obj = "*fill*" if name == "*fill*" else os.path.basename(obj or "?")
+            lma = addr - current[1] + current[2]
+            key = (obj, current[0], addr, lma)
+            objects[key] = objects.get(key, 0) + size
+
+    return regions, sections, objects
+
+
+def region_of(regions, addr):
+    for name, (origin, length) in regions.items():
+        if origin <= addr < origin + length:
+            return name
+    return None
+
+
+def main(argv):
+    if len(argv) < 2:
+        print(__doc__.strip(), file=sys.stderr)
+        return 2
+
+    regions, sections, objects = parse_map(argv[1])
+
+    # sections without contents (.bss, NOLOAD) get a load address in the map
+    # but take no space there
+    nobits = set()
+    elf_path = argv[1][:-4] if argv[1].endswith(".map") else None
+    if elf_path and os.path.exists(elf_path):
+        elf_sections, _ = elf.read_sections(elf_path)
+        nobits = {s.name for s in elf_sections.values() if s.type == elf.SHT_NOBITS}
+    loaded = lambda name, vma, lma: lma != vma and name not in nobits
+
+    budgets = {name: length for name, (origin, length) in regions.items()}
+    for arg in argv[2:]:
+        name, _, size = arg.partition("=")
+        if name not in regions:
+            print("unknown region %s, the regions are %s" % (name, " ".join(regions)), file=sys.stderr)
+            return 2
+        budgets[name] = parse_size(size)
+
+    # sections with a different load address (.data, .ramfunc) use both regions
+    used = {name: 0 for name in regions}
+    print("%-16s %-10s %10s  %s" % ("section", "address", "size", "region"))
+    for name, vma, size, lma in sections:
+        vma_region = region_of(regions, vma)
+        lma_region = region_of(regions, lma)
+        if vma_region is None:
+            continue  # debug info and other sections that are not in memory
+        where = vma_region
+        used[vma_region] += size
+        if loaded(name, vma, lma) and lma_region in used:
+            used[lma_region] += size
+            where += " (loaded from %s)" % lma_region
+        print("%-16s 0x%08x %10d  %s" % (name, vma, size, where))
+
+    per_object = {}
+    for (obj, section, vma, lma), size in objects.items():
+        object_regions = {region_of(regions, vma)}
+        if loaded(section, vma, lma):
+            object_regions.add(region_of(regions, lma))
+        for region in object_regions:
+            if region is not None:
+                per_object.setdefault(obj, {}).setdefault(region, 0)
+                per_object[obj][region] += size
+
+    names = list(regions)
+    print()
+    print("%-28s" % "object" + "".join("%10s" % n for n in names))
+    for obj in sorted(per_object, key=lambda o: -sum(per_object[o].values())):
+        print("%-28s" % obj[:28] + "".join("%10d" % per_object[obj].get(n, 0) for n in names))
+
+    print()
+    print("%-10s %10s %10s %7s" % ("region", "used", "budget", "usage"))
+    over = False
+    for name in names:
+        budget = budgets[name]
+        percent = 100.0 * used[name] / budget if budget else 0.0
+        flag = ""
+        if used[name] > budget:
+            flag = "  OVER BUDGET"
+            over = True
+        print("%-10s %10d %10d %6.1f%%%s" % (name, used[name], budget, percent, flag))
+
+    return 1 if over else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))